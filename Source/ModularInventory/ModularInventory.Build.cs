@@ -53,5 +53,8 @@ public class ModularInventory : ModuleRules
 				// ... add any modules that your module loads dynamically here ...
 			}
 			);
+		
+		// Iris replication (no-op on targets built without it)
+		SetupIrisSupport(Target);
 	}
 }
@@ -116,9 +116,7 @@ void AInventoryPickupActor::RefreshVisualFromDefinition()
 
 	// Look for our world mesh fragment on the definition
 	const UItemFragment_WorldMesh* WorldFrag =
-		Cast<UItemFragment_WorldMesh>(
-			ItemDefinition->FindFragmentByClass(UItemFragment_WorldMesh::StaticClass())
-		);
+		ItemDefinition->FindFragmentByClass<UItemFragment_WorldMesh>();
 
 	ApplyWorldMeshFragment(WorldFrag);
 }
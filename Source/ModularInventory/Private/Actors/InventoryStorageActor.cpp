@@ -3,6 +3,7 @@
 
 #include "Actors/InventoryStorageActor.h"
 
+#include "TimerManager.h"
 #include "Inventory/InventoryComponent.h"
 
 
@@ -12,6 +13,8 @@ AInventoryStorageActor::AInventoryStorageActor()
 	PrimaryActorTick.bStartWithTickEnabled = false;
 	
 	SetReplicates(true);
+	// Contents rarely change after the loot roll: stay off the consider list until something happens
+	NetDormancy = DORM_Initial;
 	
 	Inventory = CreateDefaultSubobject<UInventoryComponent>("Inventory");
 	Inventory->SetMaxSlots(8);
@@ -23,7 +26,54 @@ void AInventoryStorageActor::BeginPlay()
 	
 	if (HasAuthority())
 	{
+		// The loot roll only flushes dormancy once, later changes keep the actor awake for a while
 		Inventory->GenerateLootFromTable(LootTable);
+		
+		Inventory->OnInventoryChangedNative.AddUObject(this, &ThisClass::HandleInventoryChanged);
+		Inventory->OnMaxSlotsChanged.AddDynamic(this, &ThisClass::HandleMaxSlotsChanged);
+		Inventory->OnViewersChanged.AddUObject(this, &ThisClass::HandleViewersChanged);
 	}
 }
 
+void AInventoryStorageActor::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	GetWorldTimerManager().ClearTimer(DormancyTimerHandle);
+	
+	Super::EndPlay(EndPlayReason);
+}
+
+void AInventoryStorageActor::HandleInventoryChanged(const FInventoryChangeSet& ChangeSet)
+{
+	WakeFromDormancy();
+}
+
+void AInventoryStorageActor::HandleMaxSlotsChanged(int32 NewMaxSlots)
+{
+	WakeFromDormancy();
+}
+
+void AInventoryStorageActor::HandleViewersChanged(APlayerController* Viewer)
+{
+	// Opening the storage changes no entry, the new viewer still needs the contents
+	WakeFromDormancy();
+}
+
+void AInventoryStorageActor::WakeFromDormancy()
+{
+	// The component already flushed dormancy for this change, stay awake while it keeps changing
+	if (NetDormancy != DORM_Awake)
+	{
+		SetNetDormancy(DORM_Awake);
+	}
+	
+	if (DormancyIdleDelay > 0.f)
+	{
+		GetWorldTimerManager().SetTimer(DormancyTimerHandle, this, &ThisClass::GoDormant, DormancyIdleDelay, false);
+	}
+}
+
+void AInventoryStorageActor::GoDormant()
+{
+	SetNetDormancy(DORM_DormantAll);
+}
+
@@ -3,13 +3,23 @@
 
 #include "DataAssets/InventoryItemDefinition.h"
 
+#include "Inventory/InventoryItemInstance.h"
 #include "Inventory/Fragments/InventoryItemFragment.h"
+#include "Inventory/Fragments/ItemFragment_Stackable.h"
+#include "Inventory/Fragments/ItemFragment_UserInterface.h"
+#include "Inventory/Fragments/ItemFragment_WorldMesh.h"
 
 const UInventoryItemFragment* UInventoryItemDefinition::FindFragmentByClass(
 	TSubclassOf<UInventoryItemFragment> FragmentClass) const
 {
 	if (FragmentClass != nullptr)
 	{
+		if (bFragmentCacheBuilt)
+		{
+			const UInventoryItemFragment* const* Found = FragmentsByClass.Find(FragmentClass.Get());
+			return Found ? *Found : nullptr;
+		}
+		
 		for (UInventoryItemFragment* Fragment : Fragments)
 		{
 			if (Fragment && Fragment->IsA(FragmentClass))
@@ -28,6 +38,108 @@ void UInventoryItemDefinition::RebuildDynamicTags()
 		if (!Fragment) continue;
 		Fragment->AddDynamicTags(DynamicTags);
 	}
+	
+	RebuildHotData();
+	RebuildCombinedTags();
+}
+
+void UInventoryItemDefinition::RebuildFragmentCache()
+{
+	FragmentsByClass.Reset();
+	
+	for (const UInventoryItemFragment* Fragment : Fragments)
+	{
+		if (!Fragment) continue;
+		
+		// Register every class up to the fragment base so parent-class queries hit too (IsA semantics)
+		for (const UClass* Class = Fragment->GetClass(); Class; Class = Class->GetSuperClass())
+		{
+			if (!FragmentsByClass.Contains(Class))
+			{
+				FragmentsByClass.Add(Class, Fragment);
+			}
+			
+			if (Class == UInventoryItemFragment::StaticClass())
+				break;
+		}
+	}
+	
+	const int32 NumTypes = FInventoryFragmentTypeRegistry::Num();
+	FragmentsByType.SetNumZeroed(NumTypes);
+	for (int32 TypeIndex = 0; TypeIndex < NumTypes; ++TypeIndex)
+	{
+		const UInventoryItemFragment* const* Found = FragmentsByClass.Find(FInventoryFragmentTypeRegistry::GetClass(TypeIndex));
+		FragmentsByType[TypeIndex] = Found ? *Found : nullptr;
+	}
+	
+	bFragmentCacheBuilt = true;
+}
+
+void UInventoryItemDefinition::RebuildHotData()
+{
+	HotData = FInventoryItemHotData();
+	
+	HotData.InstanceClass = ItemInstanceClass
+		? ItemInstanceClass.Get()
+		: UInventoryItemInstance::StaticClass();
+	HotData.bNeedsInstance = !bInstanceless;
+	
+	if (const UItemFragment_Stackable* Stackable = FindFragmentByClass<UItemFragment_Stackable>())
+	{
+		HotData.bStackable = true;
+		HotData.MaxStackSize = FMath::Max(1, Stackable->GetMaxStackLimit());
+	}
+	
+	if (const UItemFragment_UserInterface* UserInterface = FindFragmentByClass<UItemFragment_UserInterface>())
+	{
+		HotData.bHasIcon = UserInterface->GetIcon() != nullptr;
+	}
+	
+	if (const UItemFragment_WorldMesh* WorldMesh = FindFragmentByClass<UItemFragment_WorldMesh>())
+	{
+		HotData.bHasWorldMesh = WorldMesh->GetStaticMesh() != nullptr || WorldMesh->GetSkeletalMesh() != nullptr;
+	}
+}
+
+void UInventoryItemDefinition::PostLoad()
+{
+	Super::PostLoad();
+	
+	RebuildFragmentCache();
+	RebuildHotData();
+	RebuildCombinedTags();
+	bRuntimeDataBuilt = true;
+}
+
+void UInventoryItemDefinition::BuildRuntimeData() const
+{
+	// Only the caches change, the definition itself stays const
+	UInventoryItemDefinition* MutableThis = const_cast<UInventoryItemDefinition*>(this);
+	MutableThis->bRuntimeDataBuilt = true;
+	
+	// Not loaded, so DynamicTags were never serialized: collect them from the fragments too
+	MutableThis->RebuildFragmentCache();
+	MutableThis->RebuildDynamicTags();
+}
+
+void UInventoryItemDefinition::RebuildCombinedTags()
+{
+	GetCombinedTags(CombinedTags);
+	++TagsVersion;
+	CombinedTagMaskVersion = MAX_uint32;
+}
+
+const FInventoryTagMask& UInventoryItemDefinition::GetCombinedTagMask() const
+{
+	EnsureRuntimeData();
+	
+	const FInventoryTagBitDomain& Domain = FInventoryTagBitDomain::Get();
+	if (CombinedTagMaskVersion != Domain.GetVersion())
+	{
+		CombinedTagMask = Domain.MakeMask(CombinedTags);
+		CombinedTagMaskVersion = Domain.GetVersion();
+	}
+	return CombinedTagMask;
 }
 
 void UInventoryItemDefinition::GetCombinedTags(FGameplayTagContainer& OutTags) const
@@ -46,15 +158,10 @@ void UInventoryItemDefinition::PostEditChangeProperty(struct FPropertyChangedEve
 {
 	Super::PostEditChangeProperty(PropertyChangedEvent);
 	
-	static const FName FragmentsName(TEXT("Fragments"));
-	if (PropertyChangedEvent.GetPropertyName() == FragmentsName ||
-		PropertyChangedEvent.GetMemberPropertyName() == FragmentsName)
-	{
-		RebuildDynamicTags();
-		//return;
-	}
-
-	// Also: maybe always rebuild on any change, it's cheap.
+	// Cheap, so every change rebuilds. Order matters: the dynamic tags and the
+	// hot data (baked at the end of RebuildDynamicTags) read the fragment cache.
+	RebuildFragmentCache();
 	RebuildDynamicTags();
+	bRuntimeDataBuilt = true;
 }
 #endif
\ No newline at end of file
@@ -39,6 +39,10 @@ void UInventoryLootTable::GenerateLoot(class UInventoryComponent* TargetInventor
 		? MinRolls
 		: Rng.RandRange(MinRolls, MaxRolls);
 
+	// Collect every roll first and add them as one batch
+	TArray<FItemAddRequest, TInlineAllocator<8>> Requests;
+	Requests.Reserve(ActualRolls);
+
 	for (int32 RollIndex = 0; RollIndex < ActualRolls; ++RollIndex)
 	{
 		const FLootItemEntry* Entry = PickRandomEntryWeighted(Rng, TargetInventory);
@@ -63,9 +67,11 @@ void UInventoryLootTable::GenerateLoot(class UInventoryComponent* TargetInventor
 			continue;
 		}
 
-		// Let the inventory's own rules handle stacking, capacity, tag query, etc.
-		TargetInventory->AddItem(ItemDef, Quantity);
+		Requests.Emplace(ItemDef, Quantity);
 	}
+
+	// Let the inventory's own rules handle stacking, capacity, tag query, etc.
+	TargetInventory->AddItems(Requests);
 }
 
 const FLootItemEntry* UInventoryLootTable::PickRandomEntryWeighted(FRandomStream& Rng,
@@ -77,18 +83,34 @@ const FLootItemEntry* UInventoryLootTable::PickRandomEntryWeighted(FRandomStream
 	TArray<float> Weights;
 	Weights.Reserve(Entries.Num());
 
-	for (const FLootItemEntry& Entry : Entries)
+	// Compile first so the context mask covers every bit the filters use
+	EnsureFiltersCompiled();
+	const FGameplayTagContainer& ContextTags = TargetInventory
+		? TargetInventory->GetContainerTags()
+		: FGameplayTagContainer::EmptyContainer;
+	const FInventoryTagMask ContextMask = FInventoryTagBitDomain::Get().MakeMask(ContextTags);
+	const bool bFilterByContainer = !ContextTags.IsEmpty();
+
+	for (int32 EntryIndex = 0; EntryIndex < Entries.Num(); ++EntryIndex)
 	{
+		const FLootItemEntry& Entry = Entries[EntryIndex];
 		if (!Entry.ItemDefinition)
 		{
 			continue;
 		}
 
-		// Optional: apply tag filter against the target inventory's container type/tags
-		if (!Entry.OptionalTagFilter.IsEmpty())
+		// Apply the tag filter against the target inventory's container tags.
+		// Containers without tags skip filtering, as before ContainerTags existed.
+		if (bFilterByContainer && !Entry.OptionalTagFilter.IsEmpty())
 		{
-			// Example: you might feed some tags representing environment or container type.
-			// For now we skip this (no external tag source), but wiring it later is easy.
+			const FInventoryCompiledTagQuery& Filter = CompiledFilters[EntryIndex];
+			const bool bPasses = Filter.IsCompiled()
+				? Filter.Matches(ContextMask)
+				: Entry.OptionalTagFilter.Matches(ContextTags);
+			if (!bPasses)
+			{
+				continue;
+			}
 		}
 
 		if (Entry.Weight <= 0.f)
@@ -132,3 +154,28 @@ const FLootItemEntry* UInventoryLootTable::PickRandomEntryWeighted(FRandomStream
 	// Fallback (floating point edge case)
 	return ValidEntries.Last();
 }
+
+void UInventoryLootTable::EnsureFiltersCompiled() const
+{
+	if (bFiltersCompiled && CompiledFilters.Num() == Entries.Num())
+	{
+		return;
+	}
+
+	CompiledFilters.Reset();
+	CompiledFilters.SetNum(Entries.Num());
+	for (int32 EntryIndex = 0; EntryIndex < Entries.Num(); ++EntryIndex)
+	{
+		CompiledFilters[EntryIndex].Compile(Entries[EntryIndex].OptionalTagFilter);
+	}
+	bFiltersCompiled = true;
+}
+
+#if WITH_EDITOR
+void UInventoryLootTable::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	bFiltersCompiled = false;
+}
+#endif
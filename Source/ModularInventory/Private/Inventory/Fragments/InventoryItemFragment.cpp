@@ -8,3 +8,34 @@ void UInventoryItemFragment::AddDynamicTags_Implementation(FGameplayTagContainer
 	if (!FragmentTags.IsEmpty())
 		TagContainer.AppendTags(FragmentTags);
 }
+
+int32 FInventoryFragmentTypeRegistry::RegisterClass(const UClass* FragmentClass)
+{
+	TArray<const UClass*>& Classes = GetClasses();
+	
+	// Template statics are per module, so the same class may be registered more than once
+	const int32 Existing = Classes.Find(FragmentClass);
+	if (Existing != INDEX_NONE)
+	{
+		return Existing;
+	}
+	
+	return Classes.Add(FragmentClass);
+}
+
+int32 FInventoryFragmentTypeRegistry::Num()
+{
+	return GetClasses().Num();
+}
+
+const UClass* FInventoryFragmentTypeRegistry::GetClass(int32 TypeIndex)
+{
+	const TArray<const UClass*>& Classes = GetClasses();
+	return Classes.IsValidIndex(TypeIndex) ? Classes[TypeIndex] : nullptr;
+}
+
+TArray<const UClass*>& FInventoryFragmentTypeRegistry::GetClasses()
+{
+	static TArray<const UClass*> Classes;
+	return Classes;
+}
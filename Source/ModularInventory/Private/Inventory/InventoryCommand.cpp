@@ -0,0 +1,103 @@
+﻿// Copyright Peter Gyarmati (BitroseStudio)
+
+
+#include "Inventory/InventoryCommand.h"
+
+#include "Inventory/InventoryComponent.h"
+
+FInventoryCommand FInventoryCommand::MakeMove(UInventoryComponent* Inventory, FInventoryItemHandle ItemHandle, int32 TargetSlotIndex)
+{
+	FInventoryCommand Command;
+	Command.Type = EInventoryCommandType::Move;
+	Command.SourceInventory = Inventory;
+	Command.ItemHandle = ItemHandle;
+	Command.TargetSlotIndex = TargetSlotIndex;
+	return Command;
+}
+
+FInventoryCommand FInventoryCommand::MakeTransfer(UInventoryComponent* Source, FInventoryItemHandle ItemHandle,
+	UInventoryComponent* Target, int32 Quantity, int32 TargetSlotIndex)
+{
+	FInventoryCommand Command;
+	Command.Type = EInventoryCommandType::Transfer;
+	Command.SourceInventory = Source;
+	Command.ItemHandle = ItemHandle;
+	Command.TargetInventory = Target;
+	Command.Quantity = Quantity;
+	Command.TargetSlotIndex = TargetSlotIndex;
+	return Command;
+}
+
+FInventoryCommand FInventoryCommand::MakeSplit(UInventoryComponent* Inventory, FInventoryItemHandle ItemHandle, int32 Quantity)
+{
+	FInventoryCommand Command;
+	Command.Type = EInventoryCommandType::Split;
+	Command.SourceInventory = Inventory;
+	Command.ItemHandle = ItemHandle;
+	Command.Quantity = Quantity;
+	return Command;
+}
+
+FInventoryCommand FInventoryCommand::MakeSplitAndMove(UInventoryComponent* Source, FInventoryItemHandle ItemHandle,
+	int32 Quantity, UInventoryComponent* Target, int32 TargetSlotIndex)
+{
+	FInventoryCommand Command;
+	Command.Type = EInventoryCommandType::SplitAndMove;
+	Command.SourceInventory = Source;
+	Command.ItemHandle = ItemHandle;
+	Command.TargetInventory = Target;
+	Command.Quantity = Quantity;
+	Command.TargetSlotIndex = TargetSlotIndex;
+	return Command;
+}
+
+FInventoryCommand FInventoryCommand::MakeSort(UInventoryComponent* Inventory, EInventorySortKey SortKey)
+{
+	FInventoryCommand Command;
+	Command.Type = EInventoryCommandType::Sort;
+	Command.SourceInventory = Inventory;
+	Command.SortKey = SortKey;
+	return Command;
+}
+
+bool FInventoryCommand::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	bOutSuccess = true;
+	
+	Ar.SerializeIntPacked(Sequence);
+	
+	uint8 TypeBits = static_cast<uint8>(Type);
+	Ar.SerializeBits(&TypeBits, 3);
+	
+	UObject* SourceObject = SourceInventory.Get();
+	UObject* TargetObject = TargetInventory.Get();
+	bOutSuccess &= Map->SerializeObject(Ar, UInventoryComponent::StaticClass(), SourceObject);
+	bOutSuccess &= Map->SerializeObject(Ar, UInventoryComponent::StaticClass(), TargetObject);
+	
+	ItemHandle.SerializePacked(Ar);
+	
+	// INDEX_NONE / -1 -> 0
+	uint32 PackedSlot = static_cast<uint32>(FMath::Max(TargetSlotIndex + 1, 0));
+	uint32 PackedQuantity = static_cast<uint32>(FMath::Max(Quantity + 1, 0));
+	Ar.SerializeIntPacked(PackedSlot);
+	Ar.SerializeIntPacked(PackedQuantity);
+	
+	static_assert(static_cast<uint8>(EInventorySortKey::MAX) <= 4, "EInventorySortKey no longer fits in 2 bits");
+	uint8 SortKeyBits = static_cast<uint8>(SortKey);
+	if (TypeBits == static_cast<uint8>(EInventoryCommandType::Sort))
+	{
+		Ar.SerializeBits(&SortKeyBits, 2);
+	}
+	
+	if (Ar.IsLoading())
+	{
+		Type = static_cast<EInventoryCommandType>(TypeBits);
+		SourceInventory = Cast<UInventoryComponent>(SourceObject);
+		TargetInventory = Cast<UInventoryComponent>(TargetObject);
+		TargetSlotIndex = static_cast<int32>(PackedSlot) - 1;
+		Quantity = static_cast<int32>(PackedQuantity) - 1;
+		SortKey = static_cast<EInventorySortKey>(SortKeyBits);
+	}
+	
+	return true;
+}
@@ -0,0 +1,184 @@
+﻿// Copyright Peter Gyarmati (BitroseStudio)
+
+
+#include "Inventory/InventoryCompiledTagQuery.h"
+
+FInventoryTagBitDomain& FInventoryTagBitDomain::Get()
+{
+	static FInventoryTagBitDomain Domain;
+	return Domain;
+}
+
+int32 FInventoryTagBitDomain::FindOrAddBit(const FGameplayTag& Tag)
+{
+	if (const int32* Existing = TagToBit.Find(Tag))
+	{
+		return *Existing;
+	}
+
+	if (TagToBit.Num() >= FInventoryTagMask::MaxBits)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("[InventoryTagBitDomain] Out of tag bits, %s will use the generic query evaluator."),
+			*Tag.ToString());
+		return INDEX_NONE;
+	}
+
+	const int32 NewBit = TagToBit.Num();
+	TagToBit.Add(Tag, NewBit);
+	++Version;
+	return NewBit;
+}
+
+int32 FInventoryTagBitDomain::FindBit(const FGameplayTag& Tag) const
+{
+	const int32* Bit = TagToBit.Find(Tag);
+	return Bit ? *Bit : INDEX_NONE;
+}
+
+FInventoryTagMask FInventoryTagBitDomain::MakeMask(const FGameplayTagContainer& Tags) const
+{
+	FInventoryTagMask Mask;
+	if (TagToBit.Num() == 0 || Tags.IsEmpty())
+	{
+		return Mask;
+	}
+
+	// Explicit tags plus all their parents (HasTag semantics)
+	const FGameplayTagContainer Expanded = Tags.GetGameplayTagParents();
+	for (const FGameplayTag& Tag : Expanded)
+	{
+		const int32 Bit = FindBit(Tag);
+		if (Bit != INDEX_NONE)
+		{
+			Mask.SetBit(Bit);
+		}
+	}
+	return Mask;
+}
+
+bool FInventoryCompiledTagQuery::Compile(const FGameplayTagQuery& Query)
+{
+	Reset();
+
+	if (Query.IsEmpty())
+	{
+		return false;
+	}
+
+	FGameplayTagQueryExpression Root;
+	Query.GetQueryExpr(Root);
+
+	if (Root.UsesTagSet())
+	{
+		// Single expression, treat as a one-term ALL list
+		FTerm& Term = Terms.AddDefaulted_GetRef();
+		if (!CompileTerm(Root, Term))
+		{
+			Reset();
+			return false;
+		}
+		ListOp = EListOp::All;
+	}
+	else
+	{
+		switch (Root.ExprType)
+		{
+		case EGameplayTagQueryExprType::AnyExprMatch: ListOp = EListOp::Any; break;
+		case EGameplayTagQueryExprType::AllExprMatch: ListOp = EListOp::All; break;
+		case EGameplayTagQueryExprType::NoExprMatch:  ListOp = EListOp::None; break;
+		default:
+			return false;
+		}
+
+		for (const FGameplayTagQueryExpression& Child : Root.ExprSet)
+		{
+			FTerm& Term = Terms.AddDefaulted_GetRef();
+			if (!CompileTerm(Child, Term))
+			{
+				Reset();
+				return false;
+			}
+		}
+	}
+
+	bCompiled = true;
+	return true;
+}
+
+void FInventoryCompiledTagQuery::Reset()
+{
+	Terms.Reset();
+	ListOp = EListOp::All;
+	bCompiled = false;
+}
+
+bool FInventoryCompiledTagQuery::CompileTerm(const FGameplayTagQueryExpression& Expr, FTerm& OutTerm)
+{
+	switch (Expr.ExprType)
+	{
+	case EGameplayTagQueryExprType::AnyTagsMatch: OutTerm.Op = ETermOp::AnyTags; break;
+	case EGameplayTagQueryExprType::AllTagsMatch: OutTerm.Op = ETermOp::AllTags; break;
+	case EGameplayTagQueryExprType::NoTagsMatch:  OutTerm.Op = ETermOp::NoTags; break;
+	default:
+		// Nested lists and exact-match variants go through the generic evaluator
+		return false;
+	}
+
+	FInventoryTagBitDomain& Domain = FInventoryTagBitDomain::Get();
+	for (const FGameplayTag& Tag : Expr.TagSet)
+	{
+		if (!Tag.IsValid())
+		{
+			return false;
+		}
+
+		const int32 Bit = Domain.FindOrAddBit(Tag);
+		if (Bit == INDEX_NONE)
+		{
+			return false;
+		}
+		OutTerm.Mask.SetBit(Bit);
+	}
+	return true;
+}
+
+bool FInventoryCompiledTagQuery::EvaluateTerm(const FTerm& Term, const FInventoryTagMask& TagMask)
+{
+	switch (Term.Op)
+	{
+	case ETermOp::AnyTags: return TagMask.HasAny(Term.Mask);
+	case ETermOp::AllTags: return TagMask.HasAll(Term.Mask);
+	case ETermOp::NoTags:  return !TagMask.HasAny(Term.Mask);
+	}
+	return false;
+}
+
+bool FInventoryCompiledTagQuery::Matches(const FInventoryTagMask& TagMask) const
+{
+	check(bCompiled);
+
+	switch (ListOp)
+	{
+	case EListOp::Any:
+		for (const FTerm& Term : Terms)
+		{
+			if (EvaluateTerm(Term, TagMask)) return true;
+		}
+		return false;
+
+	case EListOp::All:
+		for (const FTerm& Term : Terms)
+		{
+			if (!EvaluateTerm(Term, TagMask)) return false;
+		}
+		return true;
+
+	case EListOp::None:
+		for (const FTerm& Term : Terms)
+		{
+			if (EvaluateTerm(Term, TagMask)) return false;
+		}
+		return true;
+	}
+	return false;
+}
@@ -5,10 +5,18 @@
 
 #include "DataAssets/InventoryItemDefinition.h"
 #include "DataAssets/InventoryLootTable.h"
-#include "Engine/ActorChannel.h"
+#include "Engine/World.h"
+#include "TimerManager.h"
 #include "Inventory/InventoryItemInstance.h"
-#include "Inventory/Fragments/ItemFragment_Stackable.h"
+#include "Inventory/InventoryItemInstancePool.h"
+#include "Inventory/InventoryTransaction.h"
+#include "Inventory/Fragments/ItemFragment_UserInterface.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
 #include "Net/UnrealNetwork.h"
+#include "Net/Core/NetConditionGroupManager.h"
+#include "Net/Core/PushModel/PushModel.h"
+#include "Serialization/BitWriter.h"
 
 
 // void FInventoryEntry::PreReplicatedRemove(const struct FInventoryList& Serializer)
@@ -32,6 +40,46 @@ UInventoryItemInstance* FInventoryEntry::GetItemInstance() const
 	return ItemInstance;
 }
 
+bool FInventoryEntry::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	bOutSuccess = true;
+	
+	// Packed ints: typical handles, quantities and slots fit in a byte or two.
+	// The fast array only resends entries whose replication key changed, so a
+	// quantity tick costs one small entry instead of Guid + 2x int32 + references.
+	Handle.SerializePacked(Ar);
+	
+	uint32 PackedQuantity = static_cast<uint32>(FMath::Max(Quantity, 0));
+	Ar.SerializeIntPacked(PackedQuantity);
+	
+	// INDEX_NONE -> 0
+	uint32 PackedSlot = static_cast<uint32>(FMath::Max(SlotIndex + 1, 0));
+	Ar.SerializeIntPacked(PackedSlot);
+	
+	UObject* DefinitionObject = const_cast<UInventoryItemDefinition*>(ItemDef.Get());
+	bOutSuccess &= Map->SerializeObject(Ar, UInventoryItemDefinition::StaticClass(), DefinitionObject);
+	
+	// Instance-less stacks only cost this bit
+	uint8 bHasInstance = ItemInstance != nullptr;
+	Ar.SerializeBits(&bHasInstance, 1);
+	
+	UObject* InstanceObject = ItemInstance.Get();
+	if (bHasInstance)
+	{
+		bOutSuccess &= Map->SerializeObject(Ar, UInventoryItemInstance::StaticClass(), InstanceObject);
+	}
+	
+	if (Ar.IsLoading())
+	{
+		Quantity = static_cast<int32>(PackedQuantity);
+		SlotIndex = static_cast<int32>(PackedSlot) - 1;
+		ItemDef = Cast<UInventoryItemDefinition>(DefinitionObject);
+		ItemInstance = bHasInstance ? Cast<UInventoryItemInstance>(InstanceObject) : nullptr;
+	}
+	
+	return true;
+}
+
 TArray<UInventoryItemInstance*> FInventoryList::GetAllItems() const
 {
 	TArray<UInventoryItemInstance*> Results;
@@ -46,841 +94,2266 @@ TArray<UInventoryItemInstance*> FInventoryList::GetAllItems() const
 
 void FInventoryList::PreReplicatedRemove(const TArrayView<int32> RemovedIndices, int32 FinalSize)
 {
+	// Removed entries get swapped out after this call, indices are stale from here on
+	bLookupDirty = true;
+	
 	if (!IsValid(OwnerComponent)) return;
 	
+	OwnerComponent->BeginReplicationChangeScope();
 	for (int32 Index : RemovedIndices)
 	{
-		OwnerComponent->OnItemRemoved.Broadcast(Entries[Index]);
-		UE_LOG(LogTemp, Log, TEXT("[FInventoryList] PreReplicationRemove: %d"), Index);
+		OwnerComponent->PostInventoryItemRemoved(Entries[Index]);
 	}
 }
 
 void FInventoryList::PostReplicatedAdd(const TArrayView<int32> AddedIndices, int32 FinalSize)
 {
+	bLookupDirty = true;
+	
 	if (!IsValid(OwnerComponent)) return;
 	
+	OwnerComponent->BeginReplicationChangeScope();
 	for (int32 Index : AddedIndices)
 	{
-		OwnerComponent->OnItemAdded.Broadcast(Entries[Index]);
-		UE_LOG(LogTemp, Log, TEXT("[FInventoryList] PostReplicatedAdd: %d"), Index);
+		OwnerComponent->PostInventoryItemAdded(Entries[Index]);
 	}
 }
 
 void FInventoryList::PostReplicatedChange(const TArrayView<int32> ChangedIndices, int32 FinalSize)
 {
+	// Quantities may have changed, which affects the open-stack index
+	bLookupDirty = true;
+	
 	if (!IsValid(OwnerComponent)) return;
 	
+	OwnerComponent->BeginReplicationChangeScope();
 	for (int32 Index : ChangedIndices)
 	{
-		OwnerComponent->OnItemChanged.Broadcast(Entries[Index]);
-		UE_LOG(LogTemp, Log, TEXT("[FInventoryList] PostReplicatedChange: %d"), Index);
+		OwnerComponent->PostInventoryItemChanged(Entries[Index]);
 	}
 }
 
-void FInventoryList::AddItem(UInventoryItemInstance* Instance, int32 Quantity)
+void FInventoryList::PostReplicatedReceive(const FFastArraySerializer::FPostReplicatedReceiveParameters& Parameters)
 {
-	checkf(OwnerComponent, TEXT("Error! OwnerComponent not set."));
-	
-	AddItemToSlot(Instance, Quantity, OwnerComponent->FindFirstFreeSlotIndex(), OwnerComponent);
-
+	// Lookups are valid again by now, flush the whole update as one change set
+	if (IsValid(OwnerComponent))
+	{
+		OwnerComponent->EndReplicationChangeScope();
+	}
 }
 
-void FInventoryList::AddItem(UInventoryItemInstance* Instance, int32 Quantity, int32 PreferredSlotIndex)
+void FInventoryList::MarkItemDirty(FInventoryEntry& Item)
 {
-	checkf(OwnerComponent, TEXT("Error! OwnerComponent not set."));
-	
-	AddItemToSlot(Instance, Quantity, PreferredSlotIndex, OwnerComponent);
+	FFastArraySerializer::MarkItemDirty(Item);
+	if (OwnerComponent)
+	{
+		OwnerComponent->MarkInventoryEntriesDirty();
+	}
+}
 
+void FInventoryList::MarkArrayDirty()
+{
+	FFastArraySerializer::MarkArrayDirty();
+	if (OwnerComponent)
+	{
+		OwnerComponent->MarkInventoryEntriesDirty();
+	}
 }
 
-void FInventoryList::AddItemToSlot(UInventoryItemInstance* Instance, int32 Quantity, int32 SlotIndex, UInventoryComponent* InOwnerComponent)
-{	
-	FInventoryEntry NewEntry;
-	NewEntry.ItemInstance = Instance;
-	NewEntry.Quantity = Quantity;
-	NewEntry.ItemGuid = FGuid::NewGuid();
-	NewEntry.SlotIndex = SlotIndex;
+int32 FInventoryList::IndexOfHandle(FInventoryItemHandle ItemHandle) const
+{
+	if (!ItemHandle.IsValid()) return INDEX_NONE;
 	
-	UE_LOG(LogTemp, Log, TEXT("[InventoryList] AddItem: %s"),
-		*NewEntry.GetDebugString());
+	EnsureLookup();
 	
-	Entries.Add(NewEntry);
-	MarkItemDirty(NewEntry); // Is it should be Entries instead of the NewEntry?
+	// A removed or reused slot has a different generation, so stale handles miss here
+	const int32 HandleIndex = ItemHandle.GetIndex();
+	if (!HandleSlots.IsValidIndex(HandleIndex)) return INDEX_NONE;
 	
-	InOwnerComponent->PostInventoryItemAdded(NewEntry); // Is it should be Entries instead of the NewEntry?
+	const FHandleSlot& HandleSlot = HandleSlots[HandleIndex];
+	return HandleSlot.Generation == ItemHandle.GetGeneration() ? HandleSlot.EntryIndex : INDEX_NONE;
 }
 
-bool FInventoryList::RemoveItem(const FGuid& ItemGuid, int32 QuantityToRemove)
+FInventoryEntry* FInventoryList::FindEntryByHandle(FInventoryItemHandle ItemHandle)
 {
-	int32 Index = Entries.IndexOfByPredicate([&](const FInventoryEntry& Entry)
-	{
-		return Entry.ItemGuid == ItemGuid;
-	});
+	const int32 Index = IndexOfHandle(ItemHandle);
+	return Index != INDEX_NONE ? &Entries[Index] : nullptr;
+}
 
-	if (Index == INDEX_NONE)
-		return false;
+const FInventoryEntry* FInventoryList::FindEntryByHandle(FInventoryItemHandle ItemHandle) const
+{
+	const int32 Index = IndexOfHandle(ItemHandle);
+	return Index != INDEX_NONE ? &Entries[Index] : nullptr;
+}
 
-	FInventoryEntry& Entry = Entries[Index];
+int32 FInventoryList::IndexOfSlot(int32 SlotIndex) const
+{
+	EnsureLookup();
+	
+	return SlotToIndex.IsValidIndex(SlotIndex) ? SlotToIndex[SlotIndex] : INDEX_NONE;
+}
 
-	if (QuantityToRemove <= 0 || QuantityToRemove > Entry.Quantity)
-		return false;
+FInventoryEntry* FInventoryList::FindEntryBySlot(int32 SlotIndex)
+{
+	const int32 Index = IndexOfSlot(SlotIndex);
+	return Index != INDEX_NONE ? &Entries[Index] : nullptr;
+}
 
-	Entry.Quantity -= QuantityToRemove;
-	MarkItemDirty(Entry);
+const FInventoryEntry* FInventoryList::FindEntryBySlot(int32 SlotIndex) const
+{
+	const int32 Index = IndexOfSlot(SlotIndex);
+	return Index != INDEX_NONE ? &Entries[Index] : nullptr;
+}
 
-	if (Entry.Quantity <= 0)
-	{
-		// Make a copy for the callback before we remove the element
-		FInventoryEntry RemovedEntry = Entry;
-		
-		Entries.RemoveAt(Index);
-		MarkArrayDirty();
-		
-		if (OwnerComponent)
-		{
-			OwnerComponent->PostInventoryItemRemoved(RemovedEntry);
-		}
-	}
-	else
+int32 FInventoryList::FindFirstFreeSlot(int32 InMaxSlots) const
+{
+	EnsureLookup();
+	
+	// Bits past the end of the table are implicitly free
+	int32 FreeSlot = OccupiedSlots.Find(false);
+	if (FreeSlot == INDEX_NONE)
 	{
-		if (OwnerComponent)
-		{
-			OwnerComponent->PostInventoryItemChanged(Entry);
-		}
+		FreeSlot = OccupiedSlots.Num();
 	}
+	
+	return FreeSlot < InMaxSlots ? FreeSlot : INDEX_NONE;
+}
 
-	return true;
+void FInventoryList::SetEntrySlot(int32 Index, int32 NewSlotIndex)
+{
+	EnsureLookup();
+	
+	FInventoryEntry& Entry = Entries[Index];
+	ReleaseSlot(Entry.SlotIndex, Index);
+	Entry.SlotIndex = NewSlotIndex;
+	AssignSlot(NewSlotIndex, Index);
 }
 
-UInventoryComponent::UInventoryComponent()
+const TArray<int32>* FInventoryList::FindOpenStacks(const UInventoryItemDefinition* ItemDef) const
 {
-	SetIsReplicatedByDefault(true);
-	InventoryEntries.SetOwnerComponent(this);
+	EnsureLookup();
+	
+	return OpenStacks.Find(ItemDef);
 }
 
-void UInventoryComponent::GetLifetimeReplicatedProps(TArray<class FLifetimeProperty>& OutLifetimeProps) const
+void FInventoryList::SetEntryQuantity(int32 Index, int32 NewQuantity)
 {
-	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+	EnsureLookup();
 	
-	if (ContainerType == EInventoryContainerType::PlayerInventory || ContainerType == EInventoryContainerType::Hotbar)
+	Entries[Index].Quantity = NewQuantity;
+	RefreshOpenStack(Index);
+}
+
+void FInventoryList::RefreshOpenStack(int32 Index) const
+{
+	const FInventoryEntry& Entry = Entries[Index];
+	const UInventoryItemDefinition* ItemDef = Entry.GetItemDefinition();
+	if (!ItemDef)
+	{
+		return;
+	}
+	
+	const FInventoryItemHotData& HotData = ItemDef->GetHotData();
+	const bool bHasRoom = HotData.bStackable && Entry.Quantity < HotData.MaxStackSize;
+	
+	if (bHasRoom)
 	{
-		DOREPLIFETIME_CONDITION(ThisClass, InventoryEntries, COND_OwnerOnly);
-		DOREPLIFETIME_CONDITION(ThisClass, MaxSlots, COND_OwnerOnly);
+		OpenStacks.FindOrAdd(ItemDef).AddUnique(Index);
 	}
 	else
 	{
-		DOREPLIFETIME(ThisClass, InventoryEntries);
-		DOREPLIFETIME(ThisClass, MaxSlots);
+		RemoveOpenStack(ItemDef, Index);
 	}
 }
 
-int32 UInventoryComponent::FindFirstFreeSlotIndex() const
+void FInventoryList::RemoveOpenStack(const UInventoryItemDefinition* ItemDef, int32 Index) const
 {
-	const TArray<FInventoryEntry>& CachedEntries = InventoryEntries.GetAllEntriesRef();
+	TArray<int32>* Stacks = OpenStacks.Find(ItemDef);
+	if (!Stacks)
+	{
+		return;
+	}
 	
-	for (int32 i = 0; i < MaxSlots; ++i)
+	Stacks->RemoveSingleSwap(Index);
+	if (Stacks->IsEmpty())
 	{
-		const bool bIsTaken = CachedEntries.ContainsByPredicate([i](const FInventoryEntry& Entry) { return Entry.SlotIndex == i; });
-		if (!bIsTaken) return i;
+		OpenStacks.Remove(ItemDef);
 	}
-	return CachedEntries.Num();
 }
 
-void UInventoryComponent::SetMaxSlots(int32 NewMaxSlots)
+void FInventoryList::AssignSlot(int32 SlotIndex, int32 Index) const
 {
-	NewMaxSlots = FMath::Max(NewMaxSlots, 0);
-	if (MaxSlots == NewMaxSlots)
+	if (SlotIndex < 0)
 	{
 		return;
 	}
-
-	MaxSlots = NewMaxSlots;
-	//OnRep_MaxSlots();
-	HandleMaxSlotsChanged();
-}
-
-int32 UInventoryComponent::GetFreeSlotCount() const
-{
-	const int32 UsedSlots = InventoryEntries.GetEntriesCount();
-	return FMath::Max(0, MaxSlots - UsedSlots);
-}
-
-FInventoryEntry* UInventoryComponent::FindEntryByGuid(TArray<FInventoryEntry>& InEntries, const FGuid& ItemGuid)
-{
-	return InEntries.FindByPredicate(
-		[&ItemGuid](const FInventoryEntry& Item)
-		{
-			return Item.ItemGuid == ItemGuid;
-		});
-}
-
-const FInventoryEntry* UInventoryComponent::FindEntryByGuid(const TArray<FInventoryEntry>& InEntries,
-	const FGuid& ItemGuid) const
-{
-	return InEntries.FindByPredicate(
-		[&ItemGuid](const FInventoryEntry& Item)
+	
+	if (SlotIndex >= SlotToIndex.Num())
+	{
+		const int32 NumToAdd = SlotIndex + 1 - SlotToIndex.Num();
+		SlotToIndex.Reserve(SlotIndex + 1);
+		for (int32 i = 0; i < NumToAdd; ++i)
 		{
-			return Item.ItemGuid == ItemGuid;
-		});
-}
-
-int32 UInventoryComponent::FindIndexByGuid(TArray<FInventoryEntry>& InEntries, const FGuid& ItemGuid) const
-{
-	return InEntries.IndexOfByPredicate(
-			[&ItemGuid](const FInventoryEntry& Item)
-			{
-				return Item.ItemGuid == ItemGuid;
-			});
+			SlotToIndex.Add(INDEX_NONE);
+		}
+		OccupiedSlots.Add(false, NumToAdd);
+	}
+	
+	SlotToIndex[SlotIndex] = Index;
+	OccupiedSlots[SlotIndex] = true;
 }
 
-bool UInventoryComponent::FindItemByGuid(const FGuid& ItemGuid, FInventoryEntry& OutItem) const
+void FInventoryList::ReleaseSlot(int32 SlotIndex, int32 Index) const
 {
-	if (const FInventoryEntry* Found = FindEntryByGuid(InventoryEntries.GetAllEntriesRef(), ItemGuid))
+	// Only clear the slot if it still points at this entry (a swap may have reassigned it already)
+	if (SlotToIndex.IsValidIndex(SlotIndex) && SlotToIndex[SlotIndex] == Index)
 	{
-		OutItem = *Found;
-		return true;
+		SlotToIndex[SlotIndex] = INDEX_NONE;
+		OccupiedSlots[SlotIndex] = false;
 	}
-	return false;
 }
 
-void UInventoryComponent::TryAddItem(const UInventoryItemDefinition* ItemDef)
+void FInventoryList::EnsureLookup() const
 {
-	unimplemented();
+	// Also catches Entries that were filled by serialization rather than through AddItem
+	if (bLookupDirty || NumIndexedEntries != Entries.Num())
+	{
+		RebuildLookup();
+	}
 }
 
-bool UInventoryComponent::AddItem(const UInventoryItemDefinition* ItemDef, int32 Quantity)
+void FInventoryList::RebuildLookup() const
 {
-	// Authority check
-	if (GetOwnerRole() != ROLE_Authority)
+	// Keep the generations: the server allocates the next one from them
+	for (FHandleSlot& HandleSlot : HandleSlots)
 	{
-		UE_LOG(LogTemp, Warning,
-			TEXT("AddItem called on non-authority. Ignoring."));
-		return false;
+		HandleSlot.EntryIndex = INDEX_NONE;
 	}
-
-	if (!ItemDef || Quantity <= 0)
+	SlotToIndex.Reset();
+	OccupiedSlots.Reset();
+	OpenStacks.Reset();
+	
+	for (int32 Index = 0; Index < Entries.Num(); ++Index)
 	{
-		return false;
+		AssignHandle(Entries[Index].Handle, Index);
+		AssignSlot(Entries[Index].SlotIndex, Index);
+		RefreshOpenStack(Index);
 	}
+	
+	NumIndexedEntries = Entries.Num();
+	bLookupDirty = false;
+}
 
-	if (!CanAcceptItemDefinition(ItemDef))
+void FInventoryList::AssignHandle(FInventoryItemHandle ItemHandle, int32 Index) const
+{
+	if (!ItemHandle.IsValid()) return;
+	
+	const int32 HandleIndex = ItemHandle.GetIndex();
+	if (HandleIndex >= HandleSlots.Num())
 	{
-		UE_LOG(LogTemp, Log,
-			TEXT("[InventoryComponent] AddItem: %s rejected by tag filter"),
-			*GetNameSafe(ItemDef));
-		return false;
+		HandleSlots.SetNum(HandleIndex + 1);
 	}
+	
+	HandleSlots[HandleIndex].EntryIndex = Index;
+	HandleSlots[HandleIndex].Generation = ItemHandle.GetGeneration();
+}
 
-	const int32 RequestedQuantity = Quantity;
-
-	// Check stackable fragment
-	const UItemFragment_Stackable* StackableFragment =
-		Cast<UItemFragment_Stackable>(
-			ItemDef->FindFragmentByClass(UItemFragment_Stackable::StaticClass())
-		);
-
-	UE_LOG(LogTemp, Log,
-		TEXT("[InventoryComponent] AddItem: %s x%d (Stackable=%s, MaxSlots=%d, Used=%d)"),
-		*GetNameSafe(ItemDef),
-		Quantity,
-		StackableFragment ? TEXT("true") : TEXT("false"),
-		MaxSlots,
-		InventoryEntries.GetEntriesCount());
-
-	// 1) If stackable, fill existing stacks first
-	if (StackableFragment)
+FInventoryItemHandle FInventoryList::AllocateHandle()
+{
+	int32 HandleIndex;
+	if (FreeHandleIndices.Num() > 0)
 	{
-		FillExistingStacks(ItemDef, StackableFragment, Quantity);
-
-		// Fully added into existing stacks
-		if (Quantity <= 0)
-		{
-			return true;
-		}
+		HandleIndex = FreeHandleIndices.Pop();
 	}
-
-	// 2) Create new stacks / slots for remaining or non-stackable items
-	AddIntoNewSlots(ItemDef, StackableFragment, Quantity);
-
-	const bool bFullyAdded = (Quantity <= 0);
-	if (!bFullyAdded)
+	else
 	{
-		UE_LOG(LogTemp, Log,
-			TEXT("[InventoryComponent] AddItem: partially added %d of %d"),
-			RequestedQuantity - Quantity, RequestedQuantity);
+		if (HandleSlots.Num() > FInventoryItemHandle::MaxIndex)
+		{
+			UE_LOG(LogTemp, Error, TEXT("[InventoryList] AllocateHandle: out of handles (%d stacks)"), HandleSlots.Num());
+			return FInventoryItemHandle();
+		}
+		HandleIndex = HandleSlots.AddDefaulted();
 	}
-
-	return bFullyAdded;
+	
+	// Bump the generation on every reuse, skipping the reserved 0 on wrap-around
+	FHandleSlot& HandleSlot = HandleSlots[HandleIndex];
+	HandleSlot.Generation = HandleSlot.Generation == MAX_uint16 ? 1 : HandleSlot.Generation + 1;
+	
+	return FInventoryItemHandle::Make(HandleIndex, HandleSlot.Generation);
 }
 
-bool UInventoryComponent::RemoveItem(const FGuid& ItemGuid, int32 QuantityToRemove)
+void FInventoryList::ReleaseHandle(FInventoryItemHandle ItemHandle)
 {
-	return InventoryEntries.RemoveItem(ItemGuid, QuantityToRemove);
+	if (!ItemHandle.IsValid() || !HandleSlots.IsValidIndex(ItemHandle.GetIndex())) return;
+	
+	HandleSlots[ItemHandle.GetIndex()].EntryIndex = INDEX_NONE;
+	FreeHandleIndices.Add(ItemHandle.GetIndex());
 }
 
-bool UInventoryComponent::SwapItems(int32 SlotIndexA, int32 SlotIndexB)
+FInventoryItemHandle FInventoryList::AddItem(const UInventoryItemDefinition* ItemDef, UInventoryItemInstance* Instance, int32 Quantity)
 {
-	if (SlotIndexA == SlotIndexB)
-	{
-		return false;
-	}
-
-	TArray<FInventoryEntry>& Entries = InventoryEntries.GetAllEntriesRef();
-
-	if (!Entries.IsValidIndex(SlotIndexA) || !Entries.IsValidIndex(SlotIndexB))
-	{
-		return false;
-	}
-
-	FInventoryEntry& A = Entries[SlotIndexA];
-	FInventoryEntry& B = Entries[SlotIndexB];
+	checkf(OwnerComponent, TEXT("Error! OwnerComponent not set."));
+	
+	return AddItemToSlot(ItemDef, Instance, Quantity, OwnerComponent->FindFirstFreeSlotIndex(), OwnerComponent);
 
-	Entries.Swap(SlotIndexA, SlotIndexB);
+}
 
-	// Mark both dirty so replication + UI picks up change
-	InventoryEntries.MarkItemDirty(A);
-	InventoryEntries.MarkItemDirty(B);
+FInventoryItemHandle FInventoryList::AddItem(const UInventoryItemDefinition* ItemDef, UInventoryItemInstance* Instance, int32 Quantity, int32 PreferredSlotIndex)
+{
+	checkf(OwnerComponent, TEXT("Error! OwnerComponent not set."));
+	
+	return AddItemToSlot(ItemDef, Instance, Quantity, PreferredSlotIndex, OwnerComponent);
 
-	// Force a full refresh event
-	OnInventoryRefreshed.Broadcast(Entries);
+}
 
-	return true;
+FInventoryItemHandle FInventoryList::AddItemToSlot(const UInventoryItemDefinition* ItemDef, UInventoryItemInstance* Instance, int32 Quantity, int32 SlotIndex, UInventoryComponent* InOwnerComponent)
+{	
+	EnsureLookup();
+	
+	FInventoryEntry NewEntry;
+	NewEntry.ItemDef = ItemDef;
+	NewEntry.ItemInstance = Instance;
+	NewEntry.Quantity = Quantity;
+	NewEntry.Handle = AllocateHandle();
+	NewEntry.SlotIndex = SlotIndex;
+	
+	if (!NewEntry.Handle.IsValid()) return FInventoryItemHandle();
+	
+	UE_LOG(LogTemp, Log, TEXT("[InventoryList] AddItem: %s"),
+		*NewEntry.GetDebugString());
+	
+	return AddNewEntry(NewEntry, InOwnerComponent);
 }
 
-bool UInventoryComponent::SplitItemStack(const FGuid& ItemGuid, int32 SplitQuantity)
+FInventoryItemHandle FInventoryList::AddNewEntry(const FInventoryEntry& NewEntry, UInventoryComponent* InOwnerComponent)
 {
-	FGuid DummyGUID;
-	return SplitItemStackForDrag(ItemGuid, SplitQuantity, DummyGUID);
+	const int32 NewIndex = Entries.Add(NewEntry);
+	++NumIndexedEntries;
+	AssignHandle(NewEntry.Handle, NewIndex);
+	AssignSlot(NewEntry.SlotIndex, NewIndex);
+	RefreshOpenStack(NewIndex);
+	
+	// The stored copy, so it keeps the replication id
+	MarkItemDirty(Entries[NewIndex]);
+	
+	InOwnerComponent->PostInventoryItemAdded(Entries[NewIndex]);
+	
+	return NewEntry.Handle;
 }
 
-bool UInventoryComponent::SplitItemStackForDrag(const FGuid& ItemGuid, int32 SplitQuantity, FGuid& OutNewStackGuid)
+bool FInventoryList::RemoveItem(FInventoryItemHandle ItemHandle, int32 QuantityToRemove)
 {
-	OutNewStackGuid.Invalidate();
-
-	int32 Index = InventoryEntries.GetAllEntriesRef().IndexOfByPredicate([&](const FInventoryEntry& Item)
-	{
-		return Item.ItemGuid == ItemGuid;
-	});
-
+	const int32 Index = IndexOfHandle(ItemHandle);
 	if (Index == INDEX_NONE)
 		return false;
 
-	FInventoryEntry& SourceItem = InventoryEntries.GetEntryByIndex(Index);
-
-	if (SplitQuantity <= 0 || SplitQuantity >= SourceItem.Quantity)
-		return false;
+	FInventoryEntry& Entry = Entries[Index];
 
-	// Capacity check: splitting creates a new stack
-	if (MaxSlots > 0 && InventoryEntries.GetEntriesCount() >= MaxSlots)
-	{
-		UE_LOG(LogTemp, Log, TEXT("[InventoryComponent] SplitItemStackForDrag: no free slot for new stack"));
+	if (QuantityToRemove <= 0 || QuantityToRemove > Entry.Quantity)
 		return false;
-	}
 
-	// Reduce source quantity
-	SourceItem.Quantity -= SplitQuantity;
-	InventoryEntries.MarkItemDirty(SourceItem);
-	PostInventoryItemChanged(SourceItem);
+	SetEntryQuantity(Index, Entry.Quantity - QuantityToRemove);
+	MarkItemDirty(Entry);
 
-	// --- Create new instance for the new stack ---
-	if (!SourceItem.ItemInstance || !SourceItem.ItemInstance->ItemDef)
+	if (Entry.Quantity <= 0)
 	{
-		return false;
+		// Make a copy for the callback before we remove the element
+		FInventoryEntry RemovedEntry = Entry;
+		
+		RemoveEntryAt(Index);
+		MarkArrayDirty();
+		
+		if (OwnerComponent)
+		{
+			OwnerComponent->PostInventoryItemRemoved(RemovedEntry);
+			OwnerComponent->RecycleItemInstance(RemovedEntry.ItemInstance);
+		}
 	}
-	const UInventoryItemDefinition* ItemDef = SourceItem.ItemInstance->ItemDef;
-
-	UInventoryItemInstance* NewInstance = CreateItemInstance(ItemDef);
-	if (!NewInstance)
+	else
 	{
-		return false;
+		if (OwnerComponent)
+		{
+			OwnerComponent->PostInventoryItemChanged(Entry);
+		}
 	}
 
-	InventoryEntries.AddItem(NewInstance, SplitQuantity);
-
-	// The new stack is the last added
-	const TArray<FInventoryEntry>& Entries = InventoryEntries.GetAllEntriesRef();
-	if (InventoryEntries.GetEntriesCount() > 0)
-	{
-		const FInventoryEntry& NewItem = Entries.Last();
-		OutNewStackGuid = NewItem.ItemGuid;
-
-		UE_LOG(LogTemp, Log, TEXT("[InventoryComponent] SplitItemStackForDrag: Guid=%s Split=%d NewGuid=%s"),
-			*ItemGuid.ToString(), SplitQuantity, *OutNewStackGuid.ToString());
-
-		return true;
-	}
-	
-	return false;
+	return true;
 }
 
-void UInventoryComponent::SplitAndMoveItem(const FGuid& SourceItemGuid, int32 SplitQuantity,
-	UInventoryComponent* TargetInventory, int32 TargetSlotIndex)
+bool FInventoryList::ExtractItem(FInventoryItemHandle ItemHandle, FInventoryEntry& OutEntry)
 {
-	if (!TargetInventory || SplitQuantity <= 0) return;
+	const int32 Index = IndexOfHandle(ItemHandle);
+	if (Index == INDEX_NONE)
+		return false;
 	
-	FGuid NewGuid;
-	if (!SplitItemStackForDrag(SourceItemGuid, SplitQuantity, NewGuid)) return;
+	OutEntry = Entries[Index];
+	RemoveEntryAt(Index);
+	MarkArrayDirty();
 	
-	// Same inventory
-	if (TargetInventory == this)
+	// Reported as a removal, but the instance lives on in the receiving list
+	if (OwnerComponent)
 	{
-		MoveItemByGuid(NewGuid, TargetSlotIndex);
-		return;
+		OwnerComponent->PostInventoryItemRemoved(OutEntry);
 	}
 	
-	// Different inventory, try to move the new half to the target inventory
-	const bool bMoveSuccess = MoveItemToInventory(TargetInventory, NewGuid, SplitQuantity, TargetSlotIndex);
+	return true;
+}
+
+FInventoryItemHandle FInventoryList::InsertItem(const FInventoryEntry& Entry, int32 SlotIndex)
+{
+	checkf(OwnerComponent, TEXT("Error! OwnerComponent not set."));
+	EnsureLookup();
+	
+	// Fresh fast array item: the replication id belongs to the old list
+	FInventoryEntry NewEntry;
+	NewEntry.ItemDef = Entry.ItemDef;
+	NewEntry.ItemInstance = Entry.ItemInstance;
+	NewEntry.Quantity = Entry.Quantity;
+	NewEntry.ItemGuid = Entry.ItemGuid;
+	NewEntry.Handle = AllocateHandle();
+	NewEntry.SlotIndex = SlotIndex;
 	
-	if (!bMoveSuccess)
+	if (!NewEntry.Handle.IsValid()) return FInventoryItemHandle();
+	
+	return AddNewEntry(NewEntry, OwnerComponent);
+}
+
+void FInventoryList::ReleaseLocalCopy()
+{
+	if (OwnerComponent)
 	{
-		// Move failed (target full, tag filter, etc.)
-		// We must rollback the split so the player never "loses" items.
+		for (const FInventoryEntry& Entry : Entries)
+		{
+			OwnerComponent->PostInventoryItemRemoved(Entry);
+		}
+	}
+	
+	Entries.Reset();
+	// Forget the replication ids too, so a resend adds every entry again
+	FFastArraySerializer::MarkArrayDirty();
+	bLookupDirty = true;
+}
 
-		TArray<FInventoryEntry>& Items = InventoryEntries.GetAllEntriesRef();
+namespace InventoryPaging
+{
+	// Object references are NetGUIDs, usually a few bytes once the connection knows the object
+	constexpr int32 ObjectReferenceBits = 32;
+	// The fast array writes each entry's replication id in front of it
+	constexpr int32 ReplicationIdBits = 32;
+	
+	/** Bits FInventoryEntry::NetSerialize writes for the entry, with object references estimated. */
+	int32 EstimateEntryBits(const FInventoryEntry& Entry)
+	{
+		FBitWriter Writer(0, true);
+		FInventoryItemHandle Handle = Entry.GetHandle();
+		Handle.SerializePacked(Writer);
+		uint32 PackedQuantity = static_cast<uint32>(FMath::Max(Entry.GetQuantity(), 0));
+		Writer.SerializeIntPacked(PackedQuantity);
+		uint32 PackedSlot = static_cast<uint32>(FMath::Max(Entry.GetSlotIndex() + 1, 0));
+		Writer.SerializeIntPacked(PackedSlot);
 		
-		// Find the newly created stack
-		int32 NewIndex = FindIndexByGuid(Items, NewGuid);
+		const int32 NumReferences = Entry.IsItemInstanceValid() ? 2 : 1;
+		return ReplicationIdBits + static_cast<int32>(Writer.GetNumBits()) + 1 + NumReferences * ObjectReferenceBits;
+	}
+}
 
-		// Find original stack (if still around)
-		int32 SourceIndex = FindIndexByGuid(Items, SourceItemGuid);
+bool FInventoryList::NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+{
+	const int32 BudgetBits = DeltaParms.Writer && !DeltaParms.bIsWritingOnClient && OwnerComponent
+		? OwnerComponent->GetReplicationPageBudgetBits()
+		: 0;
+	if (BudgetBits > 0)
+	{
+		SelectPage(DeltaParms, BudgetBits);
+	}
+	
+	const bool bWrote = FFastArraySerializer::FastArrayDeltaSerialize<FInventoryEntry, FInventoryList>(Entries, DeltaParms, *this);
+	
+	if (PageWithheldIDs.Num() > 0)
+	{
+		// Not in this connection's new base state, so they count as new again next time
+		PageWithheldIDs.Reset();
+		OwnerComponent->SchedulePendingPages();
+	}
+	return bWrote;
+}
 
-		if (NewIndex != INDEX_NONE)
+void FInventoryList::SelectPage(const FNetDeltaSerializeInfo& DeltaParms, int32 BudgetBits)
+{
+	// What this connection was sent so far, by replication id. No state yet: nothing was sent.
+	const FNetFastTArrayBaseState* OldState = static_cast<const FNetFastTArrayBaseState*>(DeltaParms.OldState);
+	
+	// Entries are kept in slot order, so the page is the lowest slots the connection is missing
+	int32 UsedBits = 0;
+	bool bPageFull = false;
+	for (const FInventoryEntry& Entry : Entries)
+	{
+		if (Entry.ReplicationID == INDEX_NONE || (OldState && OldState->IDToCLMap.Contains(Entry.ReplicationID)))
 		{
-			FInventoryEntry& NewItem = Items[NewIndex];
-
-			if (SourceIndex != INDEX_NONE)
-			{
-				// Merge the split quantity back into the original stack
-				FInventoryEntry& SourceItem = Items[SourceIndex];
-				SourceItem.Quantity += NewItem.Quantity;
-				InventoryEntries.MarkItemDirty(SourceItem);
-				PostInventoryItemChanged(SourceItem);
-			}
-			else
+			continue;
+		}
+		
+		if (!bPageFull)
+		{
+			// The first entry always fits, so an oversized one cannot stall the list
+			const int32 EntryBits = InventoryPaging::EstimateEntryBits(Entry);
+			if (UsedBits == 0 || UsedBits + EntryBits <= BudgetBits)
 			{
-				// No original stack found (edge case). Just keep the new stack;
-				// better to have extra items than to lose them.
-				UE_LOG(LogTemp, Warning, TEXT("No original stack found."));
-				return;
+				UsedBits += EntryBits;
+				continue;
 			}
-
-			// Remove the temporary split stack
-			const int32 RestoredQty = NewItem.Quantity;
-			InventoryEntries.RemoveItem(NewGuid, RestoredQty); // will fire events
+			bPageFull = true;
 		}
+		PageWithheldIDs.Add(Entry.ReplicationID);
 	}
 }
 
-bool UInventoryComponent::MoveItemToInventory(UInventoryComponent* TargetInventory, const FGuid& ItemGuid,
-                                              int32 Quantity, int32 TargetSlotIndex)
+void FInventoryList::SortEntriesBySlot()
 {
-	if (!TargetInventory) return false;
+	Entries.StableSort([](const FInventoryEntry& A, const FInventoryEntry& B)
+	{
+		return A.SlotIndex < B.SlotIndex;
+	});
+	
+	// Same items in a new order: the fast array only has to rebuild its id map
+	FFastArraySerializer::MarkArrayDirty();
+	bLookupDirty = true;
+}
 
-	// -------- SOURCE LOOKUP --------
-	TArray<FInventoryEntry>& SourceItems = InventoryEntries.GetAllEntriesRef();
+void FInventoryList::RemoveEntryAt(int32 Index)
+{
+	EnsureLookup();
+	
+	ReleaseHandle(Entries[Index].Handle);
+	ReleaseSlot(Entries[Index].SlotIndex, Index);
+	RemoveOpenStack(Entries[Index].GetItemDefinition(), Index);
+	
+	// Order is irrelevant (slots are addressed by SlotIndex), so avoid shifting the whole array
+	const int32 LastIndex = Entries.Num() - 1;
+	Entries.RemoveAtSwap(Index);
+	--NumIndexedEntries;
+	
+	if (Entries.IsValidIndex(Index))
+	{
+		const FInventoryEntry& Moved = Entries[Index];
+		AssignHandle(Moved.Handle, Index);
+		ReleaseSlot(Moved.SlotIndex, LastIndex);
+		AssignSlot(Moved.SlotIndex, Index);
+		RemoveOpenStack(Moved.GetItemDefinition(), LastIndex);
+		RefreshOpenStack(Index);
+	}
+}
 
-	int32 SourceIndex = FindIndexByGuid(SourceItems, ItemGuid);
+UInventoryComponent::UInventoryComponent()
+{
+	SetIsReplicatedByDefault(true);
+	// Item instances only replicate through the registered list (required by Iris, cheaper on the legacy path too)
+	bReplicateUsingRegisteredSubObjectList = true;
+	bWantsInitializeComponent = true;
+	InventoryEntries.SetOwnerComponent(this);
+}
 
-	if (SourceIndex == INDEX_NONE)
+void UInventoryComponent::InitializeComponent()
+{
+	Super::InitializeComponent();
+	
+	CompileItemQuery();
+}
+
+void UInventoryComponent::GetLifetimeReplicatedProps(TArray<class FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+	
+	// Push based: idle inventories cost nothing per net tick, mutators mark the properties dirty
+	FDoRepLifetimeParams Params;
+	Params.bIsPushBased = true;
+	
+	if (ContainerType == EInventoryContainerType::PlayerInventory || ContainerType == EInventoryContainerType::Hotbar)
 	{
-		UE_LOG(LogTemp, Warning,
-			TEXT("[InventoryComponent] MoveItemToInventory: Item not found (%s)"),
-			*ItemGuid.ToString());
-		return false;
+		Params.Condition = COND_OwnerOnly;
 	}
+	
+	// Paged lists stay push based: held back pages re-dirty the list themselves (SchedulePendingPages)
+	DOREPLIFETIME_WITH_PARAMS_FAST(ThisClass, InventoryEntries, Params);
+	DOREPLIFETIME_WITH_PARAMS_FAST(ThisClass, MaxSlots, Params);
+	DOREPLIFETIME_WITH_PARAMS_FAST(ThisClass, ReplicatedSlotMask, Params);
+	
+	// Only the issuing connection reconciles against it
+	FDoRepLifetimeParams CommandParams = Params;
+	CommandParams.Condition = COND_OwnerOnly;
+	DOREPLIFETIME_WITH_PARAMS_FAST(ThisClass, LastProcessedCommandSequence, CommandParams);
+}
 
-	FInventoryEntry& SourceItem = InventoryEntries.GetEntryByIndex(SourceIndex);
+void UInventoryComponent::MarkInventoryEntriesDirty()
+{
+	if (IsInChangeScope())
+	{
+		bEntriesDirtyInScope = true;
+		return;
+	}
+	
+	MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, InventoryEntries, this);
+	FlushOwnerNetDormancy();
+}
 
-	if (!SourceItem.ItemInstance || !SourceItem.ItemInstance->ItemDef)
+void UInventoryComponent::FlushOwnerNetDormancy() const
+{
+	// A dormant owner would never send the change. Skip defaults set during construction.
+	AActor* Owner = GetOwner();
+	if (Owner && Owner->IsActorInitialized() && Owner->NetDormancy > DORM_Awake && Owner->HasAuthority())
 	{
-		return false;
+		Owner->FlushNetDormancy();
 	}
+}
 
-	const UInventoryItemDefinition* ItemDef = SourceItem.ItemInstance->ItemDef;
+int32 UInventoryComponent::FindFirstFreeSlotIndex() const
+{
+	const int32 FreeSlot = InventoryEntries.FindFirstFreeSlot(MaxSlots);
+	return FreeSlot != INDEX_NONE ? FreeSlot : InventoryEntries.GetEntriesCount();
+}
 
-	const int32 MoveQuantity = (Quantity <= 0 || Quantity > SourceItem.Quantity)
-		? SourceItem.Quantity
-		: Quantity;
+const FInventoryEntry* UInventoryComponent::FindEntryBySlot(int32 SlotIndex) const
+{
+	return InventoryEntries.FindEntryBySlot(SlotIndex);
+}
 
-	if (MoveQuantity <= 0)
+void UInventoryComponent::SetMaxSlots(int32 NewMaxSlots)
+{
+	NewMaxSlots = FMath::Max(NewMaxSlots, 0);
+	if (MaxSlots == NewMaxSlots)
 	{
-		return false;
+		return;
 	}
+
+	MaxSlots = NewMaxSlots;
+	MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, MaxSlots, this);
+	UpdateReplicatedSlotMask();
+	FlushOwnerNetDormancy();
+	//OnRep_MaxSlots();
+	HandleMaxSlotsChanged();
+}
+
+int32 UInventoryComponent::GetFreeSlotCount() const
+{
+	const int32 UsedSlots = InventoryEntries.GetEntriesCount();
+	return FMath::Max(0, MaxSlots - UsedSlots);
+}
+
+FInventoryEntry* UInventoryComponent::FindEntryByHandle(FInventoryItemHandle ItemHandle)
+{
+	return InventoryEntries.FindEntryByHandle(ItemHandle);
+}
+
+const FInventoryEntry* UInventoryComponent::FindEntryByHandle(FInventoryItemHandle ItemHandle) const
+{
+	return InventoryEntries.FindEntryByHandle(ItemHandle);
+}
+
+int32 UInventoryComponent::FindIndexByHandle(FInventoryItemHandle ItemHandle) const
+{
+	return InventoryEntries.IndexOfHandle(ItemHandle);
+}
+
+FGuid UInventoryComponent::GetOrCreatePersistentGuid(FInventoryItemHandle ItemHandle)
+{
+	if (!GetOwner() || !GetOwner()->HasAuthority()) return FGuid();
 	
-	// 🔹 NEW: respect target inventory tag filter (hotbar, etc.)
-	if (!TargetInventory->CanAcceptItemDefinition(ItemDef))
+	FInventoryEntry* Entry = FindEntryByHandle(ItemHandle);
+	if (!Entry) return FGuid();
+	
+	// Not replicated, so no dirtying needed
+	if (!Entry->ItemGuid.IsValid())
 	{
-		UE_LOG(LogTemp, Log,
-			TEXT("[InventoryComponent] MoveItemToInventory: %s rejected by target tag filter on %s"),
-			*GetNameSafe(ItemDef),
-			*GetNameSafe(TargetInventory));
-		return false;
+		Entry->ItemGuid = FGuid::NewGuid();
 	}
+	return Entry->ItemGuid;
+}
 
-	// -------- NO TARGET SLOT SPECIFIED: old behavior --------
-	if (TargetSlotIndex == INDEX_NONE)
+bool UInventoryComponent::FindItemByHandle(FInventoryItemHandle ItemHandle, FInventoryEntry& OutItem) const
+{
+	if (const FInventoryEntry* Found = FindEntryByHandle(ItemHandle))
 	{
-		const bool bFullyAdded = TargetInventory->AddItem(ItemDef, MoveQuantity);
-		if (!bFullyAdded)
-		{
-			// Simple version: if not fully added, fail move (no partial moves)
-			return false;
-		}
+		OutItem = *Found;
+		return true;
+	}
+	return false;
+}
 
-		// Remove from this inventory
-		InventoryEntries.RemoveItem(ItemGuid, MoveQuantity);
+void UInventoryComponent::TryAddItem(const UInventoryItemDefinition* ItemDef)
+{
+	unimplemented();
+}
 
-		return true;
+bool UInventoryComponent::AddItem(const UInventoryItemDefinition* ItemDef, int32 Quantity)
+{
+	if (!ItemDef || Quantity <= 0)
+	{
+		return false;
 	}
 
-	// -------- TARGET SLOT SPECIFIED: honor where the user dropped --------
+	const FItemAddRequest Request(ItemDef, Quantity);
+	return AddItems(MakeArrayView(&Request, 1));
+}
+
+namespace InventoryAddPlan
+{
+	struct FMergedRequest
+	{
+		const UInventoryItemDefinition* ItemDef = nullptr;
+		int32 Quantity = 0;
+		int32 Added = 0;
+		TArray<int32, TInlineAllocator<4>> RequestIndices;
+	};
+
+	struct FStackFill
+	{
+		int32 EntryIndex = INDEX_NONE;
+		int32 Quantity = 0;
+	};
+
+	struct FNewStack
+	{
+		int32 MergedIndex = INDEX_NONE;
+		int32 Quantity = 0;
+	};
+}
+
+bool UInventoryComponent::AddItems(TConstArrayView<FItemAddRequest> Requests, bool bAllOrNothing, TArray<int32>* OutRemainders)
+{
+	using namespace InventoryAddPlan;
 
-	// Clamp / validate TargetSlotIndex against target's MaxSlots
-	if (TargetInventory->MaxSlots > 0)
+	// Until something is applied, every request is a full remainder
+	if (OutRemainders)
 	{
-		if (TargetSlotIndex < 0 || TargetSlotIndex >= TargetInventory->MaxSlots)
+		OutRemainders->Reset(Requests.Num());
+		for (const FItemAddRequest& Request : Requests)
 		{
-			UE_LOG(LogTemp, Warning,
-				TEXT("[InventoryComponent] MoveItemToInventory: TargetSlotIndex %d out of range (MaxSlots=%d)"),
-				TargetSlotIndex, TargetInventory->MaxSlots);
-			return false;
+			OutRemainders->Add(FMath::Max(0, Request.Quantity));
 		}
 	}
-	else
+
+	// Authority check
+	if (GetOwnerRole() != ROLE_Authority)
 	{
-		TargetSlotIndex = FMath::Max(0, TargetSlotIndex);
+		UE_LOG(LogTemp, Warning,
+			TEXT("AddItems called on non-authority. Ignoring."));
+		return false;
 	}
 
-	TArray<FInventoryEntry>& TargetItems = TargetInventory->InventoryEntries.GetAllEntriesRef();
+	// 1) Merge requests by definition (first-seen order)
+	TArray<FMergedRequest, TInlineAllocator<8>> Merged;
+	bool bAllAccepted = true;
+	for (int32 RequestIndex = 0; RequestIndex < Requests.Num(); ++RequestIndex)
+	{
+		const FItemAddRequest& Request = Requests[RequestIndex];
+		const UInventoryItemDefinition* ItemDef = Request.ItemDef;
+		if (Request.Quantity <= 0)
+		{
+			continue;
+		}
+
+		if (!ItemDef || !CanAcceptItemDefinition(ItemDef))
+		{
+			UE_LOG(LogTemp, Log,
+				TEXT("[InventoryComponent] AddItems: %s rejected by tag filter"),
+				*GetNameSafe(ItemDef));
+			bAllAccepted = false;
+			continue;
+		}
 
-	// Find if there's already an item in the target slot
-	FInventoryEntry* TargetItem = TargetItems.FindByPredicate(
-		[TargetSlotIndex](const FInventoryEntry& Item)
+		FMergedRequest* Target = Merged.FindByPredicate([ItemDef](const FMergedRequest& Existing)
 		{
-			return Item.SlotIndex == TargetSlotIndex;
+			return Existing.ItemDef == ItemDef;
 		});
+		if (!Target)
+		{
+			Target = &Merged.AddDefaulted_GetRef();
+			Target->ItemDef = ItemDef;
+		}
+		Target->Quantity += Request.Quantity;
+		Target->RequestIndices.Add(RequestIndex);
+	}
+
+	// 2) Plan all stack fills and new stacks without touching the inventory
+	TArray<FStackFill, TInlineAllocator<16>> Fills;
+	TArray<FNewStack, TInlineAllocator<16>> NewStacks;
+	int32 FreeSlots = GetFreeSlotCount();
+	bool bEverythingFits = bAllAccepted;
 
-	// Check stackable trait
-	const UItemFragment_Stackable* StackableFragment =
-		ItemDef->FindFragmentByClass<UItemFragment_Stackable>();
+	for (int32 MergedIndex = 0; MergedIndex < Merged.Num(); ++MergedIndex)
+	{
+		FMergedRequest& Request = Merged[MergedIndex];
+		const FInventoryItemHotData& HotData = Request.ItemDef->GetHotData();
+		int32 Remaining = Request.Quantity;
+
+		// Top up the open stacks first
+		const TArray<int32>* OpenStacks = HotData.bStackable ? InventoryEntries.FindOpenStacks(Request.ItemDef) : nullptr;
+		if (OpenStacks)
+		{
+			for (const int32 Index : *OpenStacks)
+			{
+				if (Remaining <= 0)
+				{
+					break;
+				}
+
+				const int32 RemainingSpace = HotData.MaxStackSize - InventoryEntries.GetEntryByIndex(Index).Quantity;
+				if (RemainingSpace <= 0)
+				{
+					continue;
+				}
+
+				const int32 ToAdd = FMath::Min(RemainingSpace, Remaining);
+				Fills.Add({ Index, ToAdd });
+				Remaining -= ToAdd;
+			}
+		}
 
-	const int32 MaxStackSize = StackableFragment
-		? StackableFragment->GetMaxStackLimit()
-		: 1;
+		// Then new stacks, limited by the slots left over by the earlier requests
+		const int32 StackSize = FMath::Max(1, HotData.MaxStackSize);
+		while (Remaining > 0 && FreeSlots > 0)
+		{
+			const int32 ToAdd = FMath::Min(Remaining, StackSize);
+			NewStacks.Add({ MergedIndex, ToAdd });
+			Remaining -= ToAdd;
+			--FreeSlots;
+		}
 
-	int32 RemainingToMove = MoveQuantity;
+		Request.Added = Request.Quantity - Remaining;
+		bEverythingFits &= (Remaining == 0);
+	}
 
-	// -----------------------------
-	// 1) MERGE into existing target stack if compatible
-	// -----------------------------
-	if (TargetItem &&
-		StackableFragment &&
-		TargetItem->ItemInstance &&
-		TargetItem->ItemInstance->ItemDef == ItemDef)
+	if (bAllOrNothing && !bEverythingFits)
 	{
-		const int32 Space          = MaxStackSize - TargetItem->Quantity;
-		const int32 TransferQty    = FMath::Min(Space, RemainingToMove);
+		UE_LOG(LogTemp, Log,
+			TEXT("[InventoryComponent] AddItems: batch of %d requests does not fit, nothing added"),
+			Requests.Num());
+		return false;
+	}
 
-		if (Space > 0 && TransferQty > 0)
+	// 3) Create the instances of the new stacks. The only step that can still fail,
+	// so it runs before any entry changes and a failure leaves the inventory untouched
+	TArray<UInventoryItemInstance*, TInlineAllocator<16>> NewInstances;
+	NewInstances.Reserve(NewStacks.Num());
+	for (const FNewStack& NewStack : NewStacks)
+	{
+		const UInventoryItemDefinition* ItemDef = Merged[NewStack.MergedIndex].ItemDef;
+		UInventoryItemInstance* NewInstance = nullptr;
+		if (!CreateItemInstanceIfNeeded(ItemDef, NewInstance))
 		{
-			TargetItem->Quantity += TransferQty;
-			TargetInventory->InventoryEntries.MarkItemDirty(*TargetItem);
-			TargetInventory->PostInventoryItemChanged(*TargetItem);
+			UE_LOG(LogTemp, Error,
+				TEXT("[InventoryComponent] AddItems: failed to create instance for %s, nothing added"),
+				*GetNameSafe(ItemDef));
+			for (UInventoryItemInstance* Created : NewInstances)
+			{
+				RecycleItemInstance(Created);
+			}
+			return false;
+		}
+		NewInstances.Add(NewInstance);
+	}
 
-			// Remove moved quantity from the source stack
-			InventoryEntries.RemoveItem(ItemGuid, TransferQty);
+	// 4) Apply. Listeners get one change set for the whole batch
+	FInventoryChangeScope ChangeScope(this);
 
-			UE_LOG(LogTemp, Log,
-				TEXT("[InventoryComponent] MoveItemToInventory MERGE: %s -> TargetSlot=%d (+%d, now %d)"),
-				*ItemGuid.ToString(), TargetSlotIndex, TransferQty, TargetItem->Quantity);
+	for (const FStackFill& Fill : Fills)
+	{
+		FInventoryEntry& Entry = InventoryEntries.GetEntryByIndex(Fill.EntryIndex);
+		InventoryEntries.SetEntryQuantity(Fill.EntryIndex, Entry.Quantity + Fill.Quantity);
+		InventoryEntries.MarkItemDirty(Entry);
+		PostInventoryItemChanged(Entry);
+	}
+
+	for (int32 NewStackIndex = 0; NewStackIndex < NewStacks.Num(); ++NewStackIndex)
+	{
+		const FNewStack& NewStack = NewStacks[NewStackIndex];
+		InventoryEntries.AddItem(Merged[NewStack.MergedIndex].ItemDef, NewInstances[NewStackIndex], NewStack.Quantity);
+	}
 
-			// If we didn't move the full amount, leave the remainder in the source
-			RemainingToMove -= TransferQty;
+	// 5) Hand the added quantity back to the original requests in order
+	if (OutRemainders)
+	{
+		for (const FMergedRequest& Request : Merged)
+		{
+			int32 Added = Request.Added;
+			for (const int32 RequestIndex : Request.RequestIndices)
+			{
+				const int32 Taken = FMath::Min(Added, Requests[RequestIndex].Quantity);
+				(*OutRemainders)[RequestIndex] -= Taken;
+				Added -= Taken;
+			}
 		}
+	}
+
+	UE_LOG(LogTemp, Log,
+		TEXT("[InventoryComponent] AddItems: %d requests, %d stacks topped up, %d new stacks%s"),
+		Requests.Num(), Fills.Num(), NewStacks.Num(),
+		bEverythingFits ? TEXT("") : TEXT(" (partial)"));
+
+	return bEverythingFits;
+}
+
+bool UInventoryComponent::K2_AddItems(const TArray<FItemAddRequest>& Requests, bool bAllOrNothing, TArray<int32>& OutRemainders)
+{
+	return AddItems(Requests, bAllOrNothing, &OutRemainders);
+}
+
+bool UInventoryComponent::RemoveItem(FInventoryItemHandle ItemHandle, int32 QuantityToRemove)
+{
+	FInventoryChangeScope ChangeScope(this);
+	return InventoryEntries.RemoveItem(ItemHandle, QuantityToRemove);
+}
 
-		// We consider the operation "successful" if we moved at least something
-		return (TransferQty > 0);
+bool UInventoryComponent::SwapItems(int32 SlotIndexA, int32 SlotIndexB)
+{
+	if (SlotIndexA == SlotIndexB)
+	{
+		return false;
 	}
 
-	// -----------------------------
-	// 2) TARGET SLOT TAKEN by incompatible item -> currently we fail
-	//    (optional: implement cross-inventory swap here later)
-	// -----------------------------
-	if (TargetItem)
+	if (SlotIndexA < 0 || SlotIndexB < 0 ||
+		(MaxSlots > 0 && (SlotIndexA >= MaxSlots || SlotIndexB >= MaxSlots)))
 	{
-		UE_LOG(LogTemp, Log,
-			TEXT("[InventoryComponent] MoveItemToInventory: Target slot %d occupied by different item, swap not implemented yet."),
-			TargetSlotIndex);
 		return false;
 	}
 
-	// -----------------------------
-	// 3) EMPTY SLOT: create new stack at that exact slot
-	// -----------------------------
+	// Slot indices, not array indices: resolve the occupants through the slot table
+	const int32 IndexA = InventoryEntries.IndexOfSlot(SlotIndexA);
+	const int32 IndexB = InventoryEntries.IndexOfSlot(SlotIndexB);
 
-	// Capacity check for creating a new stack
-	if (TargetInventory->MaxSlots > 0 &&
-		TargetInventory->InventoryEntries.GetEntriesCount() >= TargetInventory->MaxSlots)
+	if (IndexA == INDEX_NONE && IndexB == INDEX_NONE)
 	{
-		UE_LOG(LogTemp, Log,
-			TEXT("[InventoryComponent] MoveItemToInventory: no free slot for new stack in target inventory"));
 		return false;
 	}
-
-	// Create instance in target inventory
-	UInventoryItemInstance* NewInstance = TargetInventory->CreateItemInstance(ItemDef);
-	if (!NewInstance)
+
+	TArray<FInventoryEntry>& Entries = InventoryEntries.GetAllEntriesRef();
+	FInventoryChangeScope ChangeScope(this);
+
+	// Mark both dirty so replication + UI picks up change
+	if (IndexA != INDEX_NONE)
+	{
+		InventoryEntries.SetEntrySlot(IndexA, SlotIndexB);
+		InventoryEntries.MarkItemDirty(Entries[IndexA]);
+		PostInventoryItemChanged(Entries[IndexA]);
+	}
+	if (IndexB != INDEX_NONE)
+	{
+		InventoryEntries.SetEntrySlot(IndexB, SlotIndexA);
+		InventoryEntries.MarkItemDirty(Entries[IndexB]);
+		PostInventoryItemChanged(Entries[IndexB]);
+	}
+
+	return true;
+}
+
+namespace InventorySort
+{
+	struct FStackRef
+	{
+		int32 SlotIndex = INDEX_NONE;
+		FInventoryItemHandle Handle;
+	};
+	
+	// Keys are resolved once per stack, the comparisons only read them
+	struct FSortItem
+	{
+		FInventoryItemHandle Handle;
+		int32 SlotIndex = INDEX_NONE;
+		int32 Quantity = 0;
+		FName Category;
+		FString DisplayName;
+		FName DefinitionName;
+	};
+	
+	// Lexically smallest tag under Parent (any tag without one). Independent of the order the tags are stored in
+	FName FindCategory(const FGameplayTagContainer& Tags, const FGameplayTag& Parent)
+	{
+		FName Category;
+		for (const FGameplayTag& Tag : Tags)
+		{
+			if (Parent.IsValid() && (Tag == Parent || !Tag.MatchesTag(Parent)))
+			{
+				continue;
+			}
+			
+			const FName TagName = Tag.GetTagName();
+			if (Category.IsNone() || TagName.LexicalLess(Category))
+			{
+				Category = TagName;
+			}
+		}
+		return Category;
+	}
+}
+
+bool UInventoryComponent::SortAndConsolidate(EInventorySortKey SortKey)
+{
+	using namespace InventorySort;
+	
+	if (GetOwnerRole() != ROLE_Authority)
+	{
+		UE_LOG(LogTemp, Warning,
+			TEXT("SortAndConsolidate called on non-authority. Ignoring."));
+		return false;
+	}
+	
+	// Everything below reaches listeners as one change set and replication as one delta
+	FInventoryChangeScope ChangeScope(this);
+	
+	// 1) Consolidate: refill the partial stacks of each definition, lowest slot first
+	TMap<const UInventoryItemDefinition*, TArray<FStackRef>> PartialStacks;
+	for (const FInventoryEntry& Entry : InventoryEntries.GetAllEntriesRef())
+	{
+		const UInventoryItemDefinition* ItemDef = Entry.GetItemDefinition();
+		if (ItemDef && ItemDef->GetHotData().bStackable && Entry.Quantity < ItemDef->GetHotData().MaxStackSize)
+		{
+			PartialStacks.FindOrAdd(ItemDef).Add({ Entry.SlotIndex, Entry.Handle });
+		}
+	}
+	
+	for (TPair<const UInventoryItemDefinition*, TArray<FStackRef>>& Stacks : PartialStacks)
+	{
+		if (Stacks.Value.Num() < 2)
+		{
+			continue;
+		}
+		
+		Stacks.Value.Sort([](const FStackRef& A, const FStackRef& B) { return A.SlotIndex < B.SlotIndex; });
+		
+		int32 Total = 0;
+		for (const FStackRef& Stack : Stacks.Value)
+		{
+			Total += InventoryEntries.FindEntryByHandle(Stack.Handle)->Quantity;
+		}
+		
+		const int32 MaxStackSize = Stacks.Key->GetHotData().MaxStackSize;
+		for (const FStackRef& Stack : Stacks.Value)
+		{
+			const int32 Index = InventoryEntries.IndexOfHandle(Stack.Handle);
+			FInventoryEntry& Entry = InventoryEntries.GetEntryByIndex(Index);
+			
+			const int32 NewQuantity = FMath::Min(Total, MaxStackSize);
+			Total -= NewQuantity;
+			
+			if (NewQuantity > Entry.Quantity)
+			{
+				InventoryEntries.SetEntryQuantity(Index, NewQuantity);
+				InventoryEntries.MarkItemDirty(Entry);
+				PostInventoryItemChanged(Entry);
+			}
+			else if (NewQuantity < Entry.Quantity)
+			{
+				// Shrinks the last stack or removes the emptied ones (entries get swapped, hence the handles)
+				InventoryEntries.RemoveItem(Stack.Handle, Entry.Quantity - NewQuantity);
+			}
+		}
+	}
+	
+	// 2) Sort: keys first, then one O(n log n) sort
+	TArray<FSortItem> Items;
+	Items.Reserve(InventoryEntries.GetEntriesCount());
+	for (const FInventoryEntry& Entry : InventoryEntries.GetAllEntriesRef())
+	{
+		const UInventoryItemDefinition* ItemDef = Entry.GetItemDefinition();
+		
+		FSortItem& Item = Items.AddDefaulted_GetRef();
+		Item.Handle = Entry.Handle;
+		Item.SlotIndex = Entry.SlotIndex;
+		Item.Quantity = Entry.Quantity;
+		Item.DefinitionName = ItemDef ? ItemDef->GetFName() : NAME_None;
+		
+		if (SortKey == EInventorySortKey::Category && ItemDef)
+		{
+			Item.Category = FindCategory(ItemDef->GetCachedCombinedTags(), SortCategoryParentTag);
+		}
+		else if (SortKey == EInventorySortKey::DisplayName && ItemDef)
+		{
+			// What the player reads, the definition's name as a fallback
+			const UItemFragment_UserInterface* UIFragment = Entry.FindFragmentByClass<UItemFragment_UserInterface>();
+			Item.DisplayName = (UIFragment ? UIFragment->GetDisplayName() : ItemDef->DisplayName).ToString();
+		}
+	}
+	
+	Items.Sort([SortKey](const FSortItem& A, const FSortItem& B)
+	{
+		switch (SortKey)
+		{
+		case EInventorySortKey::Category:
+			if (A.Category != B.Category)
+			{
+				if (A.Category.IsNone() || B.Category.IsNone()) return B.Category.IsNone();
+				return A.Category.LexicalLess(B.Category);
+			}
+			break;
+		case EInventorySortKey::DisplayName:
+			if (A.DisplayName != B.DisplayName) return A.DisplayName < B.DisplayName;
+			break;
+		case EInventorySortKey::Quantity:
+			if (A.Quantity != B.Quantity) return A.Quantity > B.Quantity;
+			break;
+		default:
+			break;
+		}
+		
+		if (A.DefinitionName != B.DefinitionName) return A.DefinitionName.LexicalLess(B.DefinitionName);
+		if (A.Quantity != B.Quantity) return A.Quantity > B.Quantity;
+		return A.SlotIndex < B.SlotIndex;
+	});
+	
+	// 3) Lay out from slot 0, touching only the stacks that actually move
+	int32 NumMoved = 0;
+	for (int32 NewSlot = 0; NewSlot < Items.Num(); ++NewSlot)
+	{
+		if (Items[NewSlot].SlotIndex == NewSlot)
+		{
+			continue;
+		}
+		
+		const int32 Index = InventoryEntries.IndexOfHandle(Items[NewSlot].Handle);
+		InventoryEntries.SetEntrySlot(Index, NewSlot);
+		InventoryEntries.MarkItemDirty(InventoryEntries.GetEntryByIndex(Index));
+		PostInventoryItemChanged(InventoryEntries.GetEntryByIndex(Index));
+		++NumMoved;
+	}
+	
+	// Paged lists send in array order, keep the lowest slots first
+	if (bPagedReplication && NumMoved > 0)
+	{
+		InventoryEntries.SortEntriesBySlot();
+	}
+	
+	UE_LOG(LogTemp, Log,
+		TEXT("[InventoryComponent] SortAndConsolidate: %d stacks, %d moved"),
+		Items.Num(), NumMoved);
+	
+	return true;
+}
+
+bool UInventoryComponent::SplitItemStack(FInventoryItemHandle ItemHandle, int32 SplitQuantity)
+{
+	FInventoryItemHandle NewStackHandle;
+	return SplitItemStackForDrag(ItemHandle, SplitQuantity, NewStackHandle);
+}
+
+bool UInventoryComponent::SplitItemStackForDrag(FInventoryItemHandle ItemHandle, int32 SplitQuantity, FInventoryItemHandle& OutNewStackHandle)
+{
+	OutNewStackHandle.Invalidate();
+
+	const FInventoryEntry* SourceItem = FindEntryByHandle(ItemHandle);
+	if (!SourceItem || SplitQuantity <= 0 || SplitQuantity >= SourceItem->Quantity)
+		return false;
+
+	// Splitting always creates a new stack, in the first free slot. Commit changes nothing
+	// if there is no room or the new stack can't get its instance
+	FInventoryTransaction Transaction;
+	Transaction.StageRemove(this, ItemHandle, SplitQuantity);
+	Transaction.StageAddToSlot(this, SourceItem->GetItemDefinition(), SplitQuantity, INDEX_NONE);
+	if (!Transaction.Commit())
+	{
+		UE_LOG(LogTemp, Log, TEXT("[InventoryComponent] SplitItemStackForDrag: could not split %s"), *ItemHandle.ToString());
+		return false;
+	}
+
+	OutNewStackHandle = Transaction.GetCreatedHandles()[0];
+
+	UE_LOG(LogTemp, Log, TEXT("[InventoryComponent] SplitItemStackForDrag: Handle=%s Split=%d NewHandle=%s"),
+		*ItemHandle.ToString(), SplitQuantity, *OutNewStackHandle.ToString());
+
+	return OutNewStackHandle.IsValid();
+}
+
+bool UInventoryComponent::SplitAndMoveItem(FInventoryItemHandle SourceItemHandle, int32 SplitQuantity,
+	UInventoryComponent* TargetInventory, int32 TargetSlotIndex)
+{
+	if (!TargetInventory || SplitQuantity <= 0) return false;
+	
+	const FInventoryEntry* SourceItem = FindEntryByHandle(SourceItemHandle);
+	if (!SourceItem || SplitQuantity >= SourceItem->Quantity) return false;
+	
+	// Different inventory: moving part of the stack is the split
+	if (TargetInventory != this)
+	{
+		return MoveItemToInventory(TargetInventory, SourceItemHandle, SplitQuantity, TargetSlotIndex);
+	}
+	
+	if (MaxSlots <= 0)
+	{
+		TargetSlotIndex = FMath::Max(0, TargetSlotIndex);
+	}
+	
+	const UInventoryItemDefinition* ItemDef = SourceItem->GetItemDefinition();
+	const FInventoryEntry* TargetItem = InventoryEntries.FindEntryBySlot(TargetSlotIndex);
+	if (!ItemDef || TargetItem == SourceItem) return false;
+	
+	FInventoryTransaction Transaction;
+	int32 MoveQuantity = SplitQuantity;
+	
+	if (TargetItem && TargetItem->GetItemDefinition() == ItemDef && ItemDef->GetHotData().bStackable)
+	{
+		// Merge what fits, the rest stays in the source stack
+		MoveQuantity = FMath::Min(SplitQuantity, ItemDef->GetHotData().MaxStackSize - TargetItem->Quantity);
+		if (MoveQuantity <= 0) return false;
+	}
+	else if (TargetItem)
+	{
+		// Make room: the occupant moves to a free slot
+		Transaction.StageMoveToSlot(this, TargetItem->Handle, INDEX_NONE);
+	}
+	
+	Transaction.StageRemove(this, SourceItemHandle, MoveQuantity);
+	Transaction.StageAddToSlot(this, ItemDef, MoveQuantity, TargetSlotIndex);
+	
+	return Transaction.Commit();
+}
+
+bool UInventoryComponent::MoveItemToInventory(UInventoryComponent* TargetInventory, FInventoryItemHandle ItemHandle,
+                                              int32 Quantity, int32 TargetSlotIndex)
+{
+	if (!TargetInventory) return false;
+
+	// -------- SOURCE LOOKUP --------
+	const FInventoryEntry* SourceItem = FindEntryByHandle(ItemHandle);
+
+	if (!SourceItem)
+	{
+		UE_LOG(LogTemp, Warning,
+			TEXT("[InventoryComponent] MoveItemToInventory: Item not found (%s)"),
+			*ItemHandle.ToString());
+		return false;
+	}
+
+	const UInventoryItemDefinition* ItemDef = SourceItem->GetItemDefinition();
+	if (!ItemDef)
+	{
+		return false;
+	}
+
+	int32 MoveQuantity = (Quantity <= 0 || Quantity > SourceItem->Quantity)
+		? SourceItem->Quantity
+		: Quantity;
+
+	if (MoveQuantity <= 0)
+	{
+		return false;
+	}
+	
+	// Within one inventory only a drop on a slot means anything. Without one, the stack
+	// would be taken out and merged straight back into its own open stack.
+	if (TargetInventory == this)
+	{
+		if (TargetSlotIndex == INDEX_NONE)
+		{
+			return false;
+		}
+		return MoveQuantity == SourceItem->Quantity
+			? MoveItemByHandle(ItemHandle, TargetSlotIndex)
+			: SplitAndMoveItem(ItemHandle, MoveQuantity, this, TargetSlotIndex);
+	}
+	
+	// 🔹 NEW: respect target inventory tag filter (hotbar, etc.)
+	if (!TargetInventory->CanAcceptItemDefinition(ItemDef))
+	{
+		UE_LOG(LogTemp, Log,
+			TEXT("[InventoryComponent] MoveItemToInventory: %s rejected by target tag filter on %s"),
+			*GetNameSafe(ItemDef),
+			*GetNameSafe(TargetInventory));
+		return false;
+	}
+	
+	// Both sides are staged and validated first, then applied at once.
+	// A failed check leaves both inventories untouched.
+	FInventoryTransaction Transaction;
+
+	// -------- NO TARGET SLOT SPECIFIED: old behavior --------
+	if (TargetSlotIndex == INDEX_NONE)
+	{
+		// No partial moves
+		Transaction.StageRemove(this, ItemHandle, MoveQuantity);
+		Transaction.StageAdd(TargetInventory, ItemDef, MoveQuantity);
+		return Transaction.Commit();
+	}
+
+	// -------- TARGET SLOT SPECIFIED: honor where the user dropped --------
+	if (TargetInventory->MaxSlots <= 0)
+	{
+		TargetSlotIndex = FMath::Max(0, TargetSlotIndex);
+	}
+
+	const FInventoryEntry* TargetItem = TargetInventory->InventoryEntries.FindEntryBySlot(TargetSlotIndex);
+	const FInventoryItemHotData& HotData = ItemDef->GetHotData();
+
+	if (TargetItem && HotData.bStackable && TargetItem->GetItemDefinition() == ItemDef)
+	{
+		// MERGE: as much as fits, the remainder stays in the source
+		MoveQuantity = FMath::Min(HotData.MaxStackSize - TargetItem->Quantity, MoveQuantity);
+		if (MoveQuantity <= 0)
+		{
+			return false;
+		}
+	}
+	else if (TargetItem)
+	{
+		// TARGET SLOT TAKEN by incompatible item -> swap the two stacks (records and instances)
+		if (MoveQuantity != SourceItem->Quantity)
+		{
+			UE_LOG(LogTemp, Log,
+				TEXT("[InventoryComponent] MoveItemToInventory: Target slot %d occupied by different item, only whole stacks swap."),
+				TargetSlotIndex);
+			return false;
+		}
+		
+		if (!Transaction.StageSwap(this, ItemHandle, TargetInventory, TargetItem->Handle) || !Transaction.Commit())
+		{
+			return false;
+		}
+		
+		UE_LOG(LogTemp, Log,
+			TEXT("[InventoryComponent] MoveItemToInventory SWAP: %s <-> TargetSlot=%d"),
+			*ItemHandle.ToString(), TargetSlotIndex);
+		return true;
+	}
+
+	if (!TargetItem && MoveQuantity == SourceItem->Quantity)
+	{
+		// Whole stack into an empty slot: the record and its instance move over
+		Transaction.StageTransfer(this, ItemHandle, TargetInventory, TargetSlotIndex);
+	}
+	else
+	{
+		// Remove first: moving a whole stack within one inventory frees its slot
+		Transaction.StageRemove(this, ItemHandle, MoveQuantity);
+		Transaction.StageAddToSlot(TargetInventory, ItemDef, MoveQuantity, TargetSlotIndex);
+	}
+
+	if (!Transaction.Commit())
+	{
+		return false;
+	}
+
+	UE_LOG(LogTemp, Log,
+		TEXT("[InventoryComponent] MoveItemToInventory: Moved %d of %s -> TargetSlot=%d"),
+		MoveQuantity, *ItemHandle.ToString(), TargetSlotIndex);
+
+	return true;
+}
+
+bool UInventoryComponent::MoveItemByHandle(FInventoryItemHandle ItemHandle, int32 TargetSlotIndex)
+{
+	TArray<FInventoryEntry>& Items = InventoryEntries.GetAllEntriesRef();
+	FInventoryChangeScope ChangeScope(this);
+
+	// Clamp target into legal slot range (0..MaxSlots-1) if MaxSlots > 0
+	if (MaxSlots > 0)
+	{
+		if (TargetSlotIndex < 0 || TargetSlotIndex >= MaxSlots)
+		{
+			UE_LOG(LogTemp, Warning,
+				TEXT("[InventoryComponent] MoveItemByHandle: TargetSlotIndex %d out of range (MaxSlots=%d)"),
+				TargetSlotIndex, MaxSlots);
+			return false;
+		}
+	}
+	else
+	{
+		TargetSlotIndex = FMath::Max(0, TargetSlotIndex);
+	}
+
+	// Find the source item by handle
+	const int32 SourceIndex = FindIndexByHandle(ItemHandle);
+
+	if (SourceIndex == INDEX_NONE)
+	{
+		UE_LOG(LogTemp, Warning,
+			TEXT("[InventoryComponent] MoveItemByHandle: Item not found (%s)"),
+			*ItemHandle.ToString());
+		return false;
+	}
+
+	FInventoryEntry* SourceItem = &Items[SourceIndex];
+
+	if (SourceItem->SlotIndex == TargetSlotIndex)
+	{
+		// Same slot, nothing to do
+		return false;
+	}
+
+	// Find if there's already an item in the target slot
+	const int32 TargetIndex = InventoryEntries.IndexOfSlot(TargetSlotIndex);
+	FInventoryEntry* TargetItem = TargetIndex != INDEX_NONE ? &Items[TargetIndex] : nullptr;
+
+	// -----------------------------
+	// 1) Try to MERGE into target stack
+	// -----------------------------
+	if (TargetItem &&
+		SourceItem->GetItemDefinition() &&
+		SourceItem->GetItemDefinition() == TargetItem->GetItemDefinition())
+	{
+		const UInventoryItemDefinition* ItemDef = SourceItem->GetItemDefinition();
+
+		// Check if this item type is stackable
+		const FInventoryItemHotData& HotData = ItemDef->GetHotData();
+
+		if (HotData.bStackable)
+		{
+			const int32 MaxStackSize = HotData.MaxStackSize;
+			const int32 CurrentTargetQty = TargetItem->Quantity;
+			const int32 CurrentSourceQty = SourceItem->Quantity;
+
+			const int32 Space = MaxStackSize - CurrentTargetQty;
+
+			if (Space > 0 && CurrentSourceQty > 0)
+			{
+				// How much can we transfer from source to target?
+				const int32 TransferQty = FMath::Min(Space, CurrentSourceQty);
+
+				// 1. Increase target quantity
+				InventoryEntries.SetEntryQuantity(TargetIndex, CurrentTargetQty + TransferQty);
+				InventoryEntries.MarkItemDirty(*TargetItem);
+				PostInventoryItemChanged(*TargetItem);
+
+				UE_LOG(LogTemp, Log,
+					TEXT("[InventoryComponent] MoveItemByHandle MERGE: %s -> Slot=%d (+%d, now %d)"),
+					*ItemHandle.ToString(), TargetSlotIndex, TransferQty, TargetItem->Quantity);
+
+				// 2. Remove that amount from the source stack.
+				//    This will either shrink it or completely remove it,
+				//    and will correctly MarkArrayDirty / broadcast events.
+				//    Entry pointers are not valid after this (removal swaps entries).
+				InventoryEntries.RemoveItem(ItemHandle, TransferQty);
+
+				return true;
+			}
+		}
+	}
+
+	// -----------------------------
+	// 2) Fallback: swap or move
+	// -----------------------------
+	if (TargetItem)
+	{
+		// Different item or can't merge: swap slot indices
+		const int32 OldSourceSlot = SourceItem->SlotIndex;
+		InventoryEntries.SetEntrySlot(SourceIndex, TargetSlotIndex);
+		InventoryEntries.SetEntrySlot(TargetIndex, OldSourceSlot);
+
+		InventoryEntries.MarkItemDirty(*SourceItem);
+		InventoryEntries.MarkItemDirty(*TargetItem);
+		PostInventoryItemChanged(*SourceItem);
+		PostInventoryItemChanged(*TargetItem);
+	}
+	else
+	{
+		// Empty slot: just move the source
+		InventoryEntries.SetEntrySlot(SourceIndex, TargetSlotIndex);
+		InventoryEntries.MarkItemDirty(*SourceItem);
+		PostInventoryItemChanged(*SourceItem);
+	}
+
+	UE_LOG(LogTemp, Log,
+		TEXT("[InventoryComponent] MoveItemByHandle: Handle=%s -> Slot=%d"),
+		*ItemHandle.ToString(), TargetSlotIndex);
+
+	return true;
+}
+
+bool UInventoryComponent::CanAcceptItemDefinition(const UInventoryItemDefinition* ItemDef) const
+{
+	if (!ItemDef)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Invalid ItemDefinition!"));
+		return false;
+	}
+
+	// If no query configured, accept everything
+	if (AllowedItemTagQuery.IsEmpty())
+	{
+		return true;
+	}
+
+	const FObjectKey DefinitionKey(ItemDef);
+	const uint32 TagsVersion = ItemDef->GetTagsVersion();
+	if (const FAcceptedDefinition* Cached = AcceptedDefinitionCache.Find(DefinitionKey))
+	{
+		if (Cached->TagsVersion == TagsVersion)
+		{
+			return Cached->bAccepted;
+		}
+	}
+
+	const FGameplayTagContainer& Tags = ItemDef->GetCachedCombinedTags();
+	const bool bMatches = CompiledItemQuery.IsCompiled()
+		? CompiledItemQuery.Matches(ItemDef->GetCombinedTagMask())
+		: AllowedItemTagQuery.Matches(Tags);
+	AcceptedDefinitionCache.Add(DefinitionKey, FAcceptedDefinition{ TagsVersion, bMatches });
+
+	UE_LOG(LogTemp, Verbose,
+		TEXT("[InventoryComponent][%s] CanAcceptItemDefinition: %s Tags=%s -> %s"),
+		*GetName(),
+		*GetNameSafe(ItemDef),
+		*Tags.ToStringSimple(),
+		bMatches ? TEXT("ACCEPT") : TEXT("REJECT"));
+
+	return bMatches;
+}
+
+void UInventoryComponent::SetAllowedItemTagQuery(const FGameplayTagQuery& NewQuery)
+{
+	AllowedItemTagQuery = NewQuery;
+	CompileItemQuery();
+}
+
+void UInventoryComponent::CompileItemQuery()
+{
+	AcceptedDefinitionCache.Reset();
+	
+	if (!CompiledItemQuery.Compile(AllowedItemTagQuery) && !AllowedItemTagQuery.IsEmpty())
+	{
+		UE_LOG(LogTemp, Verbose, TEXT("[InventoryComponent][%s] AllowedItemTagQuery not compilable, using generic evaluator"),
+			*GetName());
+	}
+}
+
+void UInventoryComponent::GenerateLootFromTable(UInventoryLootTable* LootTable, int32 RandomSeed)
+{
+	if (!LootTable)
+	{
+		return;
+	}
+
+	AActor* OwnerActor = GetOwner();
+	if (!OwnerActor || !OwnerActor->HasAuthority())
+	{
+		// Only the server should generate loot; clients will get it via replication.
+		return;
+	}
+
+	LootTable->GenerateLoot(this, RandomSeed);
+}
+
+void UInventoryComponent::PostInventoryItemAdded(const FInventoryEntry& Item)
+{
+	// Calls outside of a scope still go through one, so they flush right away
+	FInventoryChangeScope ChangeScope(this);
+	RecordChange(Item, EPendingChange::Added);
+}
+
+void UInventoryComponent::PostInventoryItemRemoved(const FInventoryEntry& Item)
+{
+	FInventoryChangeScope ChangeScope(this);
+	RecordChange(Item, EPendingChange::Removed);
+}
+
+void UInventoryComponent::PostInventoryItemChanged(const FInventoryEntry& Item)
+{
+	FInventoryChangeScope ChangeScope(this);
+	RecordChange(Item, EPendingChange::Changed);
+}
+
+void UInventoryComponent::BeginChangeScope()
+{
+	++ChangeScopeDepth;
+}
+
+void UInventoryComponent::EndChangeScope()
+{
+	check(ChangeScopeDepth > 0);
+	
+	if (--ChangeScopeDepth == 0)
+	{
+		if (bEntriesDirtyInScope)
+		{
+			bEntriesDirtyInScope = false;
+			MarkInventoryEntriesDirty();
+		}
+		UpdateReplicatedSlotMask();
+		BroadcastPendingChanges();
+		FlushRecycledInstances();
+	}
+}
+
+void UInventoryComponent::RecycleItemInstance(UInventoryItemInstance* Instance)
+{
+	if (!Instance || GetOwnerRole() != ROLE_Authority)
+	{
+		return;
+	}
+	
+	// Stop replicating it right away, it's no longer part of this inventory
+	if (IsUsingRegisteredSubObjectList())
+	{
+		RemoveReplicatedSubObject(Instance);
+	}
+	
+	PendingRecycledInstances.Add(Instance);
+	if (!IsInChangeScope())
+	{
+		FlushRecycledInstances();
+	}
+}
+
+void UInventoryComponent::FlushRecycledInstances()
+{
+	if (PendingRecycledInstances.Num() == 0)
+	{
+		return;
+	}
+	
+	UInventoryItemInstancePool* Pool = UInventoryItemInstancePool::Get(GetWorld());
+	for (UInventoryItemInstance* Instance : PendingRecycledInstances)
+	{
+		if (Pool)
+		{
+			Pool->Release(Instance);
+		}
+	}
+	PendingRecycledInstances.Reset();
+}
+
+void UInventoryComponent::BeginReplicationChangeScope()
+{
+	if (!bReplicationScopeOpen)
+	{
+		bReplicationScopeOpen = true;
+		BeginChangeScope();
+	}
+}
+
+void UInventoryComponent::EndReplicationChangeScope()
+{
+	if (bReplicationScopeOpen)
+	{
+		bReplicationScopeOpen = false;
+		EndChangeScope();
+	}
+}
+
+void UInventoryComponent::RecordChange(const FInventoryEntry& Entry, EPendingChange Kind)
+{
+	const int32* ExistingIndex = PendingChangeIndices.Find(Entry.Handle);
+	if (!ExistingIndex)
+	{
+		PendingChangeIndices.Add(Entry.Handle, PendingChanges.Num());
+		FPendingChange& NewPending = PendingChanges.AddDefaulted_GetRef();
+		NewPending.Kind = Kind;
+		NewPending.Handle = Entry.Handle;
+		if (Kind == EPendingChange::Removed)
+		{
+			NewPending.RemovedEntry = Entry;
+		}
+		return;
+	}
+	
+	// Fold into the existing record
+	FPendingChange& Pending = PendingChanges[*ExistingIndex];
+	if (Kind == EPendingChange::Removed)
+	{
+		Pending.RemovedEntry = Entry;
+	}
+	
+	switch (Kind)
+	{
+	case EPendingChange::Added:
+		// Removed then re-added reads as a change
+		Pending.Kind = Pending.Kind == EPendingChange::Removed ? EPendingChange::Changed : EPendingChange::Added;
+		break;
+	case EPendingChange::Changed:
+		// Added stays added (listeners see the final state)
+		if (Pending.Kind != EPendingChange::Added)
+		{
+			Pending.Kind = EPendingChange::Changed;
+		}
+		break;
+	case EPendingChange::Removed:
+		// Added and removed in the same scope: listeners never saw it
+		Pending.Kind = Pending.Kind == EPendingChange::Added ? EPendingChange::None : EPendingChange::Removed;
+		break;
+	default:
+		break;
+	}
+}
+
+void UInventoryComponent::BroadcastPendingChanges()
+{
+	if (PendingChanges.Num() == 0)
+	{
+		return;
+	}
+	
+	FInventoryChangeSet ChangeSet;
+	for (const FPendingChange& Pending : PendingChanges)
+	{
+		if (Pending.Kind == EPendingChange::None)
+		{
+			continue;
+		}
+		
+		if (Pending.Kind == EPendingChange::Removed)
+		{
+			ChangeSet.Removed.Add(Pending.RemovedEntry);
+			continue;
+		}
+		
+		// Report the state at the end of the scope
+		if (const FInventoryEntry* Current = InventoryEntries.FindEntryByHandle(Pending.Handle))
+		{
+			(Pending.Kind == EPendingChange::Added ? ChangeSet.Added : ChangeSet.Changed).Add(*Current);
+		}
+	}
+	
+	PendingChanges.Reset();
+	PendingChangeIndices.Reset();
+	
+	if (ChangeSet.IsEmpty())
+	{
+		return;
+	}
+	
+	UE_LOG(LogTemp, Log, TEXT("[InventoryComponent][%s] Changes: +%d -%d ~%d"),
+		*GetName(), ChangeSet.Added.Num(), ChangeSet.Removed.Num(), ChangeSet.Changed.Num());
+	
+	OnInventoryChangedNative.Broadcast(ChangeSet);
+	
+	// Blueprint events go through the reflection thunks, only pay for them if someone listens
+	if (OnItemRemoved.IsBound())
+	{
+		for (const FInventoryEntry& Item : ChangeSet.Removed)
+		{
+			OnItemRemoved.Broadcast(Item);
+		}
+	}
+	if (OnItemAdded.IsBound())
+	{
+		for (const FInventoryEntry& Item : ChangeSet.Added)
+		{
+			OnItemAdded.Broadcast(Item);
+		}
+	}
+	if (OnItemChanged.IsBound())
+	{
+		for (const FInventoryEntry& Item : ChangeSet.Changed)
+		{
+			OnItemChanged.Broadcast(Item);
+		}
+	}
+	if (OnInventoryChanged.IsBound())
+	{
+		OnInventoryChanged.Broadcast(ChangeSet);
+	}
+	if (OnInventoryRefreshed.IsBound())
+	{
+		OnInventoryRefreshed.Broadcast(InventoryEntries.GetAllEntriesRef());
+	}
+}
+
+#if WITH_EDITOR
+void UInventoryComponent::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+	
+	if (PropertyChangedEvent.GetMemberPropertyName() == GET_MEMBER_NAME_CHECKED(ThisClass, AllowedItemTagQuery))
+	{
+		CompileItemQuery();
+	}
+}
+#endif
+
+void UInventoryComponent::ReadyForReplication()
+{
+	Super::ReadyForReplication();
+	
+	// Viewer-only: the component (and with it its item instances) replicates to the viewer group only
+	if (UsesViewerReplication() && GetOwner() && GetOwner()->HasAuthority())
+	{
+		UE::Net::FNetConditionGroupManager::RegisterSubObjectInGroup(this, GetViewerNetGroup());
+		GetOwner()->SetReplicatedComponentNetCondition(this, COND_NetGroup);
+	}
+	
+	if (bPagedReplication && GetOwnerRole() == ROLE_Authority)
+	{
+		InventoryEntries.SortEntriesBySlot();
+		UpdateReplicatedSlotMask();
+	}
+	
+	if (IsUsingRegisteredSubObjectList())
+	{
+		for (const FInventoryEntry& Entry : InventoryEntries.GetAllEntriesRef())
+		{
+			if (!Entry.ItemInstance) continue;
+			
+			UInventoryItemInstance* Instance = Entry.ItemInstance.Get();
+			if (IsValid(Instance))
+			{
+				AddReplicatedSubObject(Instance);
+			}
+		}
+	}
+}
+
+UInventoryComponent* UInventoryComponent::FindCommandRouter(const APlayerController* PlayerController)
+{
+	if (!PlayerController) return nullptr;
+	
+	// Anything on the controller or its pawn is owned by the player's connection, prefer the main inventory
+	TArray<UInventoryComponent*> Candidates;
+	PlayerController->GetComponents(Candidates);
+	if (const APawn* Pawn = PlayerController->GetPawn())
+	{
+		TArray<UInventoryComponent*> PawnInventories;
+		Pawn->GetComponents(PawnInventories);
+		Candidates.Append(PawnInventories);
+	}
+	
+	for (UInventoryComponent* Candidate : Candidates)
+	{
+		if (Candidate->ContainerType == EInventoryContainerType::PlayerInventory)
+		{
+			return Candidate;
+		}
+	}
+	return Candidates.Num() > 0 ? Candidates[0] : nullptr;
+}
+
+uint32 UInventoryComponent::SubmitCommand(FInventoryCommand Command)
+{
+	if (!Command.SourceInventory)
+	{
+		Command.SourceInventory = this;
+	}
+	
+	// Listen server / standalone: nothing to send
+	if (GetOwnerRole() == ROLE_Authority)
+	{
+		ExecuteCommand(Command, GetOwningPlayerController());
+		return 0;
+	}
+	
+	Command.Sequence = ++LastSubmittedCommandSequence;
+	QueuedCommands.Add(Command);
+	PredictCommand(Command);
+	
+	// Everything queued this frame goes out as one batch
+	if (!bCommandFlushScheduled)
+	{
+		if (UWorld* World = GetWorld())
+		{
+			bCommandFlushScheduled = true;
+			World->GetTimerManager().SetTimerForNextTick(this, &ThisClass::FlushQueuedCommands);
+		}
+	}
+	
+	return Command.Sequence;
+}
+
+void UInventoryComponent::K2_SubmitCommand(const FInventoryCommand& Command)
+{
+	SubmitCommand(Command);
+}
+
+void UInventoryComponent::FlushQueuedCommands()
+{
+	bCommandFlushScheduled = false;
+	
+	while (QueuedCommands.Num() > 0)
+	{
+		const int32 BatchSize = FMath::Min(QueuedCommands.Num(), MaxCommandsPerBatch);
+		ServerExecuteCommands(TArray<FInventoryCommand>(QueuedCommands.GetData(), BatchSize));
+		QueuedCommands.RemoveAt(0, BatchSize);
+	}
+}
+
+void UInventoryComponent::ServerExecuteCommands_Implementation(const TArray<FInventoryCommand>& Commands)
+{
+	if (Commands.Num() == 0) return;
+	
+	const APlayerController* Issuer = GetOwningPlayerController();
+	
+	TArray<uint32> RejectedSequences;
+	uint32 LastSequence = 0;
+	{
+		// Changes of the whole batch go out as one change set
+		FInventoryChangeScope ChangeScope(this);
+		
+		for (int32 CommandIndex = 0; CommandIndex < Commands.Num(); ++CommandIndex)
+		{
+			const FInventoryCommand& Command = Commands[CommandIndex];
+			
+			// Oversized batches only come from broken or malicious clients
+			if (CommandIndex >= MaxCommandsPerBatch || !ExecuteCommand(Command, Issuer))
+			{
+				RejectedSequences.Add(Command.Sequence);
+			}
+			LastSequence = FMath::Max(LastSequence, Command.Sequence);
+		}
+	}
+	
+	if (LastSequence > LastProcessedCommandSequence)
+	{
+		LastProcessedCommandSequence = LastSequence;
+		MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, LastProcessedCommandSequence, this);
+	}
+	
+	ClientAckCommands(LastSequence, RejectedSequences);
+}
+
+void UInventoryComponent::ClientAckCommands_Implementation(uint32 LastSequence, const TArray<uint32>& RejectedSequences)
+{
+	for (uint32 Sequence : RejectedSequences)
+	{
+		UE_LOG(LogTemp, Log, TEXT("[InventoryComponent][%s] Command %u rejected"), *GetName(), Sequence);
+	}
+	
+	// Predictions are not dropped here: the RPC can overtake the property update carrying the results
+	OnCommandsAcknowledged.Broadcast(LastSequence, RejectedSequences);
+}
+
+void UInventoryComponent::OnRep_LastProcessedCommandSequence()
+{
+	ReconcilePredictions(LastProcessedCommandSequence);
+}
+
+bool UInventoryComponent::PredictCommand(const FInventoryCommand& Command)
+{
+	if (!bPredictCommands || bPagedReplication) return false;
+	
+	// Only commands that stay within this inventory, the sequence only tells about this component's state
+	if ((Command.SourceInventory && Command.SourceInventory != this) || (Command.TargetInventory && Command.TargetInventory != this))
+	{
+		return false;
+	}
+	if (Command.Type != EInventoryCommandType::Move && Command.Type != EInventoryCommandType::SplitAndMove)
+	{
+		return false;
+	}
+	
+	const int32 TargetSlot = Command.TargetSlotIndex;
+	if (TargetSlot < 0 || (MaxSlots > 0 && TargetSlot >= MaxSlots)) return false;
+	
+	FInventoryEntry Source;
+	if (!FindDisplayedEntryByHandle(Command.ItemHandle, Source)) return false;
+	
+	const int32 SourceSlot = Source.SlotIndex;
+	if (SourceSlot == TargetSlot) return false;
+	
+	const FInventoryEntry* Target = FindDisplayedEntryBySlot(TargetSlot);
+	const UInventoryItemDefinition* ItemDef = Source.GetItemDefinition();
+	const bool bSameStackable = Target && ItemDef && Target->GetItemDefinition() == ItemDef && ItemDef->GetHotData().bStackable;
+	const int32 TargetSpace = bSameStackable ? ItemDef->GetHotData().MaxStackSize - Target->Quantity : 0;
+	
+	FInventoryEntry EmptySlot;
+	EmptySlot.Quantity = 0;
+	
+	FInventoryPrediction Prediction;
+	Prediction.Sequence = Command.Sequence;
+	
+	if (Command.Type == EInventoryCommandType::Move)
+	{
+		// Mirrors MoveItemByHandle: merge, else swap or move
+		if (TargetSpace > 0)
+		{
+			const int32 TransferQty = FMath::Min(TargetSpace, Source.Quantity);
+			FInventoryEntry NewTarget = *Target;
+			NewTarget.Quantity += TransferQty;
+			Source.Quantity -= TransferQty;
+			
+			if (Source.Quantity <= 0)
+			{
+				// Merged away
+				EmptySlot.Handle = Source.Handle;
+			}
+			Prediction.Slots.Add(TargetSlot, NewTarget);
+			Prediction.Slots.Add(SourceSlot, Source.Quantity > 0 ? Source : EmptySlot);
+		}
+		else
+		{
+			if (Target)
+			{
+				FInventoryEntry Swapped = *Target;
+				Swapped.SlotIndex = SourceSlot;
+				Prediction.Slots.Add(SourceSlot, Swapped);
+			}
+			else
+			{
+				Prediction.Slots.Add(SourceSlot, EmptySlot);
+			}
+			Source.SlotIndex = TargetSlot;
+			Prediction.Slots.Add(TargetSlot, Source);
+		}
+	}
+	else
 	{
-		return false;
+		// Mirrors SplitAndMoveItem for the outcomes that don't depend on the server's free slot choice:
+		// the split lands in an empty slot or fully merges into the target
+		const int32 SplitQty = Command.Quantity;
+		if (SplitQty <= 0 || SplitQty >= Source.Quantity) return false;
+		if (MaxSlots > 0 && InventoryEntries.GetEntriesCount() >= MaxSlots) return false;
+		
+		if (!Target)
+		{
+			// The server creates the stack, its handle is unknown until then
+			FInventoryEntry NewStack;
+			NewStack.ItemDef = ItemDef;
+			NewStack.Quantity = SplitQty;
+			NewStack.SlotIndex = TargetSlot;
+			Prediction.Slots.Add(TargetSlot, NewStack);
+		}
+		else if (TargetSpace >= SplitQty)
+		{
+			FInventoryEntry NewTarget = *Target;
+			NewTarget.Quantity += SplitQty;
+			Prediction.Slots.Add(TargetSlot, NewTarget);
+		}
+		else
+		{
+			return false;
+		}
+		
+		Source.Quantity -= SplitQty;
+		Prediction.Slots.Add(SourceSlot, Source);
 	}
-
-	TargetInventory->InventoryEntries.AddItem(NewInstance, RemainingToMove, TargetSlotIndex);
-
-	// Remove from this inventory
-	InventoryEntries.RemoveItem(ItemGuid, RemainingToMove);
-
-	UE_LOG(LogTemp, Log,
-		TEXT("[InventoryComponent] MoveItemToInventory: Moved %d of %s -> TargetSlot=%d"),
-		RemainingToMove, *ItemGuid.ToString(), TargetSlotIndex);
-
+	
+	TArray<int32> ChangedSlots;
+	Prediction.Slots.GenerateKeyArray(ChangedSlots);
+	Predictions.Add(MoveTemp(Prediction));
+	
+	OnPredictedSlotsChanged.Broadcast(ChangedSlots);
 	return true;
 }
 
-bool UInventoryComponent::MoveItemByGuid(const FGuid& ItemGuid, int32 TargetSlotIndex)
+bool UInventoryComponent::FindDisplayedEntryByHandle(FInventoryItemHandle ItemHandle, FInventoryEntry& OutEntry) const
 {
-	TArray<FInventoryEntry>& Items = InventoryEntries.GetAllEntriesRef();
-
-	// Clamp target into legal slot range (0..MaxSlots-1) if MaxSlots > 0
-	if (MaxSlots > 0)
+	if (!ItemHandle.IsValid()) return false;
+	
+	for (int32 PredictionIndex = Predictions.Num() - 1; PredictionIndex >= 0; --PredictionIndex)
 	{
-		if (TargetSlotIndex < 0 || TargetSlotIndex >= MaxSlots)
+		bool bMergedAway = false;
+		for (const TPair<int32, FInventoryEntry>& Slot : Predictions[PredictionIndex].Slots)
 		{
-			UE_LOG(LogTemp, Warning,
-				TEXT("[InventoryComponent] MoveItemByGuid: TargetSlotIndex %d out of range (MaxSlots=%d)"),
-				TargetSlotIndex, MaxSlots);
-			return false;
+			if (Slot.Value.Handle != ItemHandle) continue;
+			
+			if (Slot.Value.Quantity > 0)
+			{
+				OutEntry = Slot.Value;
+				return true;
+			}
+			bMergedAway = true;
 		}
+		if (bMergedAway) return false;
 	}
-	else
-	{
-		TargetSlotIndex = FMath::Max(0, TargetSlotIndex);
-	}
-
-	// Find the source item by Guid
-	FInventoryEntry* SourceItem = FindEntryByGuid(Items, ItemGuid);
+	
+	const FInventoryEntry* Entry = InventoryEntries.FindEntryByHandle(ItemHandle);
+	if (!Entry) return false;
+	
+	OutEntry = *Entry;
+	return true;
+}
 
-	if (!SourceItem)
+const FInventoryEntry* UInventoryComponent::FindDisplayedEntryBySlot(int32 SlotIndex) const
+{
+	for (int32 PredictionIndex = Predictions.Num() - 1; PredictionIndex >= 0; --PredictionIndex)
 	{
-		UE_LOG(LogTemp, Warning,
-			TEXT("[InventoryComponent] MoveItemByGuid: Item not found (%s)"),
-			*ItemGuid.ToString());
-		return false;
+		if (const FInventoryEntry* Predicted = Predictions[PredictionIndex].Slots.Find(SlotIndex))
+		{
+			return Predicted->Quantity > 0 ? Predicted : nullptr;
+		}
 	}
+	
+	return InventoryEntries.FindEntryBySlot(SlotIndex);
+}
 
-	if (SourceItem->SlotIndex == TargetSlotIndex)
+bool UInventoryComponent::IsSlotPredicted(int32 SlotIndex) const
+{
+	for (const FInventoryPrediction& Prediction : Predictions)
 	{
-		// Same slot, nothing to do
-		return false;
+		if (Prediction.Slots.Contains(SlotIndex)) return true;
 	}
+	return false;
+}
 
-	// Find if there's already an item in the target slot
-	FInventoryEntry* TargetItem = Items.FindByPredicate(
-		[TargetSlotIndex](const FInventoryEntry& Item)
-		{
-			return Item.SlotIndex == TargetSlotIndex;
-		});
-
-	// -----------------------------
-	// 1) Try to MERGE into target stack
-	// -----------------------------
-	if (TargetItem &&
-		SourceItem->ItemInstance && TargetItem->ItemInstance &&
-		SourceItem->ItemInstance->ItemDef &&
-		SourceItem->ItemInstance->ItemDef == TargetItem->ItemInstance->ItemDef)
+void UInventoryComponent::ReconcilePredictions(uint32 ProcessedSequence)
+{
+	// Confirmed, rejected or mispredicted alike: the replicated entries now hold the server's result
+	TArray<int32> ChangedSlots;
+	int32 NumAnswered = 0;
+	for (; NumAnswered < Predictions.Num() && Predictions[NumAnswered].Sequence <= ProcessedSequence; ++NumAnswered)
 	{
-		const UInventoryItemDefinition* ItemDef = SourceItem->ItemInstance->ItemDef;
-
-		// Check if this item type is stackable
-		const UItemFragment_Stackable* StackableFragment =
-			ItemDef->FindFragmentByClass<UItemFragment_Stackable>();
-
-		if (StackableFragment)
+		for (const TPair<int32, FInventoryEntry>& Slot : Predictions[NumAnswered].Slots)
 		{
-			const int32 MaxStackSize = StackableFragment->GetMaxStackLimit();
-			const int32 CurrentTargetQty = TargetItem->Quantity;
-			const int32 CurrentSourceQty = SourceItem->Quantity;
-
-			const int32 Space = MaxStackSize - CurrentTargetQty;
-
-			if (Space > 0 && CurrentSourceQty > 0)
-			{
-				// How much can we transfer from source to target?
-				const int32 TransferQty = FMath::Min(Space, CurrentSourceQty);
-
-				// 1. Increase target quantity
-				TargetItem->Quantity += TransferQty;
-				InventoryEntries.MarkItemDirty(*TargetItem);
-				PostInventoryItemChanged(*TargetItem);
-
-				// 2. Remove that amount from the source stack.
-				//    This will either shrink it or completely remove it,
-				//    and will correctly MarkArrayDirty / broadcast events.
-				InventoryEntries.RemoveItem(SourceItem->ItemGuid, TransferQty);
-
-				UE_LOG(LogTemp, Log,
-					TEXT("[InventoryComponent] MoveItemByGuid MERGE: %s -> Slot=%d (+%d, now %d)"),
-					*ItemGuid.ToString(), TargetSlotIndex, TransferQty, TargetItem->Quantity);
-
-				OnInventoryRefreshed.Broadcast(Items);
-				return true;
-			}
+			ChangedSlots.AddUnique(Slot.Key);
 		}
 	}
+	
+	if (NumAnswered == 0) return;
+	
+	Predictions.RemoveAt(0, NumAnswered);
+	OnPredictedSlotsChanged.Broadcast(ChangedSlots);
+}
 
-	// -----------------------------
-	// 2) Fallback: swap or move
-	// -----------------------------
-	if (TargetItem)
+bool UInventoryComponent::ExecuteCommand(const FInventoryCommand& Command, const APlayerController* Issuer)
+{
+	// SubmitCommand fills in the source, so a null one arrived unresolved or was forged.
+	// Never fall back to this component: the handle may belong to a different inventory.
+	UInventoryComponent* Source = Command.SourceInventory.Get();
+	if (!Source)
 	{
-		// Different item or can't merge: swap slot indices
-		const int32 OldSourceSlot = SourceItem->SlotIndex;
-		SourceItem->SlotIndex = TargetSlotIndex;
-		TargetItem->SlotIndex = OldSourceSlot;
-
-		InventoryEntries.MarkItemDirty(*SourceItem);
-		InventoryEntries.MarkItemDirty(*TargetItem);
+		return false;
 	}
-	else
+	
+	const bool bNeedsTarget = Command.Type == EInventoryCommandType::Transfer || Command.Type == EInventoryCommandType::SplitAndMove;
+	if (bNeedsTarget && !Command.TargetInventory)
 	{
-		// Empty slot: just move the source
-		SourceItem->SlotIndex = TargetSlotIndex;
-		InventoryEntries.MarkItemDirty(*SourceItem);
+		return false;
 	}
-
-	UE_LOG(LogTemp, Log,
-		TEXT("[InventoryComponent] MoveItemByGuid: Guid=%s -> Slot=%d"),
-		*ItemGuid.ToString(), TargetSlotIndex);
-
-	OnInventoryRefreshed.Broadcast(Items);
-	return true;
-}
-
-bool UInventoryComponent::CanAcceptItemDefinition(const UInventoryItemDefinition* ItemDef) const
-{
-	if (!ItemDef)
+	UInventoryComponent* Target = Command.TargetInventory ? Command.TargetInventory.Get() : Source;
+	
+	if (!Source->CanBeAccessedBy(Issuer) || !Target->CanBeAccessedBy(Issuer))
 	{
-		UE_LOG(LogTemp, Error, TEXT("Invalid ItemDefinition!"));
 		return false;
 	}
-
-	// If no query configured, accept everything
-	if (AllowedItemTagQuery.IsEmpty())
+	
+	switch (Command.Type)
 	{
-		UE_LOG(LogTemp, Log,
-			TEXT("[InventoryComponent][%s] CanAcceptItemDefinition: NO QUERY – accepting %s"),
-			*GetName(), *GetNameSafe(ItemDef));
-		return true;
+	case EInventoryCommandType::Move:
+		return Source->MoveItemByHandle(Command.ItemHandle, Command.TargetSlotIndex);
+	case EInventoryCommandType::Transfer:
+		return Source->MoveItemToInventory(Target, Command.ItemHandle, Command.Quantity, Command.TargetSlotIndex);
+	case EInventoryCommandType::Split:
+		return Source->SplitItemStack(Command.ItemHandle, Command.Quantity);
+	case EInventoryCommandType::SplitAndMove:
+		return Source->SplitAndMoveItem(Command.ItemHandle, Command.Quantity, Target, Command.TargetSlotIndex);
+	case EInventoryCommandType::Sort:
+		if (Command.SortKey >= EInventorySortKey::MAX) return false;
+		return Source->SortAndConsolidate(Command.SortKey);
+	default:
+		return false;
 	}
-
-	FGameplayTagContainer Tags;
-	ItemDef->GetCombinedTags(Tags);
-
-	const bool bMatches = AllowedItemTagQuery.Matches(Tags);
-
-	UE_LOG(LogTemp, Log,
-		TEXT("[InventoryComponent][%s] CanAcceptItemDefinition: %s Tags=%s -> %s"),
-		*GetName(),
-		*GetNameSafe(ItemDef),
-		*Tags.ToStringSimple(),
-		bMatches ? TEXT("ACCEPT") : TEXT("REJECT"));
-
-	return bMatches;
 }
 
-void UInventoryComponent::GenerateLootFromTable(UInventoryLootTable* LootTable, int32 RandomSeed)
+bool UInventoryComponent::CanBeAccessedBy(const APlayerController* PlayerController) const
 {
-	if (!LootTable)
+	// Server-side callers are trusted
+	if (!PlayerController) return true;
+	
+	// Inventories of the player's own actors (pawn, controller, ...)
+	bool bOwnedByPlayer = false;
+	for (const AActor* Actor = GetOwner(); Actor && !bOwnedByPlayer; Actor = Actor->GetOwner())
 	{
-		return;
+		bOwnedByPlayer = Actor == PlayerController;
 	}
-
-	AActor* OwnerActor = GetOwner();
-	if (!OwnerActor || !OwnerActor->HasAuthority())
+	
+	// Anything else only while the server has the player registered as a viewer (opened it)
+	if (!bOwnedByPlayer && !IsViewer(PlayerController))
 	{
-		// Only the server should generate loot; clients will get it via replication.
-		return;
+		return false;
 	}
-
-	LootTable->GenerateLoot(this, RandomSeed);
+	
+	// Game rules on top, e.g. a range check
+	return AuthorizeAccess(PlayerController);
 }
 
-void UInventoryComponent::PostInventoryItemAdded(const FInventoryEntry& Item)
+bool UInventoryComponent::AuthorizeAccess_Implementation(const APlayerController* PlayerController) const
 {
-	UE_LOG(LogTemp, Log, TEXT("[InventoryComponent] Item Added: %s"),
-		*Item.GetDebugString());
-	OnItemAdded.Broadcast(Item);
-	
-	// 🔹 Make sure all listeners (including widgets on clients) fully refresh
-	OnInventoryRefreshed.Broadcast(InventoryEntries.GetAllEntriesRef());
+	return true;
 }
 
-void UInventoryComponent::PostInventoryItemRemoved(const FInventoryEntry& Item)
+APlayerController* UInventoryComponent::GetOwningPlayerController() const
 {
-	UE_LOG(LogTemp, Log, TEXT("[InventoryComponent] Item Removed: %s"),
-		*Item.GetDebugString());
-	OnItemRemoved.Broadcast(Item);
-	
-	// 🔹 Make sure all listeners (including widgets on clients) fully refresh
-	OnInventoryRefreshed.Broadcast(InventoryEntries.GetAllEntriesRef());
+	for (AActor* Actor = GetOwner(); Actor; Actor = Actor->GetOwner())
+	{
+		if (APlayerController* PlayerController = Cast<APlayerController>(Actor))
+		{
+			return PlayerController;
+		}
+	}
+	return nullptr;
 }
 
-void UInventoryComponent::PostInventoryItemChanged(const FInventoryEntry& Item)
+bool UInventoryComponent::UsesViewerReplication() const
 {
-	UE_LOG(LogTemp, Log, TEXT("[InventoryComponent] Item Changed: %s"),
-		*Item.GetDebugString());
-	OnItemChanged.Broadcast(Item);
-	
-	// 🔹 Make sure all listeners (including widgets on clients) fully refresh
-	OnInventoryRefreshed.Broadcast(InventoryEntries.GetAllEntriesRef());
+	return bReplicateToViewersOnly
+		&& ContainerType != EInventoryContainerType::PlayerInventory
+		&& ContainerType != EInventoryContainerType::Hotbar;
 }
 
-bool UInventoryComponent::ReplicateSubobjects(UActorChannel* Channel, FOutBunch* Bunch, FReplicationFlags* RepFlags)
+FName UInventoryComponent::GetViewerNetGroup() const
 {
-	bool WroteSomething = Super::ReplicateSubobjects(Channel, Bunch, RepFlags);
+	return FName(TEXT("InventoryViewers"), GetUniqueID());
+}
 
-	for (FInventoryEntry& Entry : InventoryEntries.GetAllEntriesRef())
+void UInventoryComponent::AddViewer(APlayerController* Viewer)
+{
+	if (!Viewer || GetOwnerRole() != ROLE_Authority) return;
+	if (IsViewer(Viewer)) return;
+	
+	auto IsGone = [](const TWeakObjectPtr<APlayerController>& Existing) { return !Existing.IsValid(); };
+	Viewers.RemoveAll(IsGone);
+	Viewers.Add(Viewer);
+	
+	// Replicated to every relevant connection anyway: being a viewer only grants command access
+	if (!UsesViewerReplication())
 	{
-		if (!Entry.ItemInstance) continue;
-		
-		UInventoryItemInstance* Instance = Entry.ItemInstance.Get();
-		if (Instance && IsValid(Instance))
+		OnViewersChanged.Broadcast(Viewer);
+		return;
+	}
+	
+	FormerViewers.RemoveAll(IsGone);
+	const bool bRejoining = FormerViewers.Remove(Viewer) > 0;
+	Viewer->IncludeInNetConditionGroup(GetViewerNetGroup());
+	
+	if (bPagedReplication)
+	{
+		InventoryEntries.SortEntriesBySlot();
+	}
+	
+	// A first-time viewer's connection has no baseline yet and gets the full array anyway.
+	// A returning one still holds the state it was last sent and may have released its copy
+	// since (ReleaseViewedContents): bump every entry so it arrives again. The fast array state
+	// is shared, so the viewers already watching get the same resend; opening is rare enough.
+	if (bRejoining)
+	{
+		FInventoryChangeScope ChangeScope(this);
+		for (FInventoryEntry& Entry : InventoryEntries.GetAllEntriesRef())
 		{
-			WroteSomething |= Channel->ReplicateSubobject(Instance, *Bunch, *RepFlags);
+			InventoryEntries.MarkItemDirty(Entry);
 		}
+		InventoryEntries.MarkArrayDirty();
+		MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, MaxSlots, this);
 	}
-
-	return WroteSomething;
+	
+	// Nothing changed for a first-time viewer, but a dormant owner would never open its channel
+	FlushOwnerNetDormancy();
+	OnViewersChanged.Broadcast(Viewer);
 }
 
-void UInventoryComponent::ReadyForReplication()
+void UInventoryComponent::RemoveViewer(APlayerController* Viewer)
 {
-	Super::ReadyForReplication();
+	if (!Viewer || GetOwnerRole() != ROLE_Authority) return;
 	
-	if (IsUsingRegisteredSubObjectList())
+	if (Viewers.Remove(Viewer) > 0)
 	{
-		for (const FInventoryEntry& Entry : InventoryEntries.GetAllEntriesRef())
+		if (UsesViewerReplication())
 		{
-			if (!Entry.ItemInstance) continue;
-			
-			UInventoryItemInstance* Instance = Entry.ItemInstance.Get();
-			if (IsValid(Instance))
-			{
-				AddReplicatedSubObject(Instance);
-			}
+			Viewer->RemoveFromNetConditionGroup(GetViewerNetGroup());
+			FormerViewers.AddUnique(Viewer);
+			FlushOwnerNetDormancy();
 		}
+		
+		OnViewersChanged.Broadcast(Viewer);
 	}
 }
 
+bool UInventoryComponent::IsViewer(const APlayerController* Viewer) const
+{
+	return Viewer && Viewers.Contains(Viewer);
+}
+
+void UInventoryComponent::ReleaseViewedContents()
+{
+	if (GetOwnerRole() == ROLE_Authority || !UsesViewerReplication()) return;
+	
+	FInventoryChangeScope ChangeScope(this);
+	InventoryEntries.ReleaseLocalCopy();
+}
+
 UInventoryItemInstance* UInventoryComponent::CreateItemInstance(const UInventoryItemDefinition* ItemDef)
 {
 	if (!ItemDef)
@@ -894,16 +2367,19 @@ UInventoryItemInstance* UInventoryComponent::CreateItemInstance(const UInventory
 		return nullptr;
 	}
 
-	// Choose instance class (fallback to base instance if asset doesn’t specify)
-	TSubclassOf<UInventoryItemInstance> InstanceClass;
-	if (ItemDef->ItemInstanceClass)
-		InstanceClass = ItemDef->ItemInstanceClass;
-	else
+	// Choose instance class (baked with a fallback to the base instance if asset doesn’t specify)
+	TSubclassOf<UInventoryItemInstance> InstanceClass = ItemDef->GetHotData().InstanceClass;
+	if (!InstanceClass)
 		InstanceClass = UInventoryItemInstance::StaticClass();
 
+	// Reuse an instance this actor released earlier (split/merge churn), else allocate.
 	// Lyra uses actor as outer (UE-127172), do the same
-	UInventoryItemInstance* NewInstance =
-		NewObject<UInventoryItemInstance>(OwnerActor, InstanceClass);
+	UInventoryItemInstancePool* Pool = UInventoryItemInstancePool::Get(GetWorld());
+	UInventoryItemInstance* NewInstance = Pool ? Pool->Acquire(InstanceClass, OwnerActor) : nullptr;
+	if (!NewInstance)
+	{
+		NewInstance = NewObject<UInventoryItemInstance>(OwnerActor, InstanceClass);
+	}
 
 	// Bind definition
 	NewInstance->Initialize(ItemDef, OwnerActor);
@@ -926,85 +2402,84 @@ UInventoryItemInstance* UInventoryComponent::CreateItemInstance(const UInventory
 	return NewInstance;
 }
 
-void UInventoryComponent::FillExistingStacks(const UInventoryItemDefinition* ItemDef,
-	const UItemFragment_Stackable* StackableFragment, int32& Quantity)
+bool UInventoryComponent::CreateItemInstanceIfNeeded(const UInventoryItemDefinition* ItemDef, UInventoryItemInstance*& OutInstance)
 {
-	if (!StackableFragment || Quantity <= 0)
+	OutInstance = nullptr;
+	if (!ItemDef)
 	{
-		return;
+		return false;
 	}
 
-	const int32 MaxStackSize = StackableFragment->GetMaxStackLimit();
-
-	for (FInventoryEntry& Entry : InventoryEntries.GetAllEntriesRef())
+	// Instance-less stack: the entry carries the definition, nothing to create
+	if (!ItemDef->GetHotData().bNeedsInstance)
 	{
-		if (!Entry.ItemInstance || Entry.ItemInstance->ItemDef != ItemDef)
-		{
-			continue;
-		}
-
-		const int32 RemainingSpace = MaxStackSize - Entry.Quantity;
-		if (RemainingSpace <= 0)
-		{
-			continue;
-		}
-
-		const int32 ToAdd = FMath::Min(RemainingSpace, Quantity);
-		Entry.Quantity += ToAdd;
-		Quantity       -= ToAdd;
+		return true;
+	}
 
-		InventoryEntries.MarkItemDirty(Entry);
+	OutInstance = CreateItemInstance(ItemDef);
+	return OutInstance != nullptr;
+}
 
-		if (GetOwnerRole() == ROLE_Authority)
-		{
-			PostInventoryItemChanged(Entry);
-		}
+bool UInventoryComponent::IsSlotPending(int32 SlotIndex) const
+{
+	if (!bPagedReplication || GetOwnerRole() == ROLE_Authority || SlotIndex < 0) return false;
+	
+	const int32 ByteIndex = SlotIndex >> 3;
+	if (!ReplicatedSlotMask.IsValidIndex(ByteIndex)) return false;
+	
+	const bool bOccupied = (ReplicatedSlotMask[ByteIndex] & (1 << (SlotIndex & 7))) != 0;
+	return bOccupied && !FindEntryBySlot(SlotIndex);
+}
 
-		if (Quantity <= 0)
-		{
-			break;
-		}
-	}
+int32 UInventoryComponent::GetReplicationPageBudgetBits() const
+{
+	return bPagedReplication && GetOwnerRole() == ROLE_Authority ? FMath::Max(ReplicationPageBytes, 1) * 8 : 0;
 }
 
-void UInventoryComponent::AddIntoNewSlots(const UInventoryItemDefinition* ItemDef,
-	const UItemFragment_Stackable* StackableFragment, int32& Quantity)
+void UInventoryComponent::SchedulePendingPages()
 {
-	if (Quantity <= 0)
+	if (bPendingPagesScheduled) return;
+	
+	// Not from inside replication: the push model clears dirty state once the object was replicated
+	if (UWorld* World = GetWorld())
 	{
-		return;
+		bPendingPagesScheduled = true;
+		World->GetTimerManager().SetTimerForNextTick(this, &ThisClass::SendPendingPages);
 	}
+}
 
-	// Non-stackable: treat as stack size 1
-	const int32 MaxStackSize = StackableFragment
-		? StackableFragment->GetMaxStackLimit()
-		: 1;
+void UInventoryComponent::SendPendingPages()
+{
+	bPendingPagesScheduled = false;
+	
+	// A new array key keeps the fast array from skipping connections whose last page was partial
+	InventoryEntries.MarkArrayDirty();
+}
 
-	while (Quantity > 0)
+void UInventoryComponent::UpdateReplicatedSlotMask()
+{
+	if (!bPagedReplication || GetOwnerRole() != ROLE_Authority) return;
+	
+	TArray<uint8> NewMask;
+	NewMask.SetNumZeroed(FMath::DivideAndRoundUp(FMath::Max(MaxSlots, 0), 8));
+	for (const FInventoryEntry& Entry : InventoryEntries.GetAllEntriesRef())
 	{
-		// Capacity check: inventory is always limited now
-		if (InventoryEntries.GetEntriesCount() >= MaxSlots)
+		if (Entry.SlotIndex >= 0 && Entry.SlotIndex < MaxSlots)
 		{
-			UE_LOG(LogTemp, Log,
-				TEXT("[InventoryComponent] AddItem: no free slots left, stopping (Remaining=%d)"),
-				Quantity);
-			break;
-		}
-
-		const int32 AddQuantity = FMath::Min(Quantity, MaxStackSize);
-
-		UInventoryItemInstance* NewInstance = CreateItemInstance(ItemDef);
-		if (!NewInstance)
-		{
-			UE_LOG(LogTemp, Error,
-				TEXT("[InventoryComponent] AddItem: failed to create instance for %s"),
-				*GetNameSafe(ItemDef));
-			break;
+			NewMask[Entry.SlotIndex >> 3] |= 1 << (Entry.SlotIndex & 7);
 		}
-
-		InventoryEntries.AddItem(NewInstance, AddQuantity);
-		Quantity -= AddQuantity;
 	}
+	
+	if (NewMask != ReplicatedSlotMask)
+	{
+		ReplicatedSlotMask = MoveTemp(NewMask);
+		MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, ReplicatedSlotMask, this);
+	}
+}
+
+void UInventoryComponent::OnRep_ReplicatedSlotMask()
+{
+	OnPendingSlotsChanged.Broadcast();
 }
 
 void UInventoryComponent::OnRep_MaxSlots()
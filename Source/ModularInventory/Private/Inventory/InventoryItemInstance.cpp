@@ -5,8 +5,10 @@
 
 #include "IDetailTreeNode.h"
 #include "DataAssets/InventoryItemDefinition.h"
+#include "GameFramework/Actor.h"
 #include "Inventory/Fragments/InventoryItemFragment.h"
 #include "Net/UnrealNetwork.h"
+#include "Net/Core/PushModel/PushModel.h"
 
 UInventoryItemInstance::UInventoryItemInstance(const FObjectInitializer& ObjectInitializer)
 {
@@ -16,6 +18,51 @@ void UInventoryItemInstance::Initialize(const UInventoryItemDefinition* InItemDe
 {
 	ItemDef = InItemDef;
 	OwningActor = InOwner;
+	MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, ItemDef, this);
+}
+
+void UInventoryItemInstance::ResetForPool()
+{
+	ItemDef = nullptr;
+	InstanceTags.Reset();
+	OwningActor = nullptr;
+	MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, ItemDef, this);
+	MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, InstanceTags, this);
+}
+
+void UInventoryItemInstance::CopyStateFrom(const UInventoryItemInstance* Other)
+{
+	if (!Other) return;
+	
+	InstanceTags = Other->InstanceTags;
+	MarkInstanceTagsDirty();
+}
+
+void UInventoryItemInstance::AddInstanceTag(FGameplayTag Tag)
+{
+	if (!Tag.IsValid() || InstanceTags.HasTagExact(Tag)) return;
+	
+	InstanceTags.AddTag(Tag);
+	MarkInstanceTagsDirty();
+}
+
+void UInventoryItemInstance::RemoveInstanceTag(FGameplayTag Tag)
+{
+	if (InstanceTags.RemoveTag(Tag))
+	{
+		MarkInstanceTagsDirty();
+	}
+}
+
+void UInventoryItemInstance::MarkInstanceTagsDirty()
+{
+	MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, InstanceTags, this);
+	
+	// Replicates through the owner's channel, which may be dormant
+	if (OwningActor && OwningActor->NetDormancy > DORM_Awake && OwningActor->HasAuthority())
+	{
+		OwningActor->FlushNetDormancy();
+	}
 }
 
 const UInventoryItemFragment* UInventoryItemInstance::FindFragmentByClass(
@@ -30,6 +77,9 @@ void UInventoryItemInstance::GetLifetimeReplicatedProps(TArray<FLifetimeProperty
 {
 	UObject::GetLifetimeReplicatedProps(OutLifetimeProps);
 	
-	DOREPLIFETIME(ThisClass, ItemDef);
-	DOREPLIFETIME(ThisClass, InstanceTags);
+	FDoRepLifetimeParams Params;
+	Params.bIsPushBased = true;
+	
+	DOREPLIFETIME_WITH_PARAMS_FAST(ThisClass, ItemDef, Params);
+	DOREPLIFETIME_WITH_PARAMS_FAST(ThisClass, InstanceTags, Params);
 }
@@ -0,0 +1,106 @@
+﻿// Copyright Peter Gyarmati (BitroseStudio)
+
+
+#include "Inventory/InventoryItemInstancePool.h"
+
+#include "Engine/World.h"
+#include "TimerManager.h"
+#include "Inventory/InventoryItemInstance.h"
+
+UInventoryItemInstancePool* UInventoryItemInstancePool::Get(const UWorld* World)
+{
+	return World ? World->GetSubsystem<UInventoryItemInstancePool>() : nullptr;
+}
+
+UInventoryItemInstance* UInventoryItemInstancePool::Acquire(TSubclassOf<UInventoryItemInstance> InstanceClass, const AActor* Owner)
+{
+	if (!Owner)
+	{
+		return nullptr;
+	}
+	
+	FInventoryItemInstancePoolBucket* Bucket = Buckets.Find({ InstanceClass.Get(), Owner });
+	if (!Bucket)
+	{
+		return nullptr;
+	}
+	
+	// Every entry belongs to Owner, most recently released first
+	while (Bucket->Instances.Num() > 0)
+	{
+		UInventoryItemInstance* Instance = Bucket->Instances.Pop();
+		if (IsValid(Instance))
+		{
+			return Instance;
+		}
+	}
+	
+	return nullptr;
+}
+
+void UInventoryItemInstancePool::Release(UInventoryItemInstance* Instance)
+{
+	if (!IsValid(Instance))
+	{
+		return;
+	}
+	
+	const AActor* Owner = Cast<AActor>(Instance->GetOuter());
+	if (!IsValid(Owner))
+	{
+		return;
+	}
+	
+	Instance->ResetForPool();
+	
+	FInventoryItemInstancePoolBucket& Bucket = Buckets.FindOrAdd({ Instance->GetClass(), Owner });
+	if (Bucket.Instances.Num() >= MaxPooledPerBucket)
+	{
+		Bucket.Instances.RemoveAt(0);
+	}
+	Bucket.Instances.Add(Instance);
+}
+
+int32 UInventoryItemInstancePool::GetNumPooled() const
+{
+	int32 Total = 0;
+	for (const TPair<FInventoryItemInstancePoolKey, FInventoryItemInstancePoolBucket>& Pair : Buckets)
+	{
+		Total += Pair.Value.Instances.Num();
+	}
+	return Total;
+}
+
+void UInventoryItemInstancePool::PruneDeadOwners()
+{
+	for (auto It = Buckets.CreateIterator(); It; ++It)
+	{
+		if (!It.Key().Owner.IsValid())
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
+
+void UInventoryItemInstancePool::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+	
+	InWorld.GetTimerManager().SetTimer(PruneTimerHandle, this, &ThisClass::PruneDeadOwners, PruneInterval, true);
+}
+
+void UInventoryItemInstancePool::Deinitialize()
+{
+	if (UWorld* World = GetWorld())
+	{
+		World->GetTimerManager().ClearTimer(PruneTimerHandle);
+	}
+	Buckets.Reset();
+	
+	Super::Deinitialize();
+}
+
+bool UInventoryItemInstancePool::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
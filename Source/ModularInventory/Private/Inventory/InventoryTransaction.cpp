@@ -0,0 +1,509 @@
+﻿// Copyright Peter Gyarmati (BitroseStudio)
+
+
+#include "Inventory/InventoryTransaction.h"
+
+#include "DataAssets/InventoryItemDefinition.h"
+#include "Inventory/InventoryComponent.h"
+#include "Inventory/InventoryItemInstance.h"
+
+FInventoryTransaction::FInventoryState* FInventoryTransaction::FindOrAddState(UInventoryComponent* Inventory)
+{
+	if (bFailed || bCommitted)
+	{
+		bFailed = true;
+		return nullptr;
+	}
+	
+	if (!Inventory || Inventory->GetOwnerRole() != ROLE_Authority)
+	{
+		Fail(TEXT("no authority over the inventory"));
+		return nullptr;
+	}
+	
+	for (FInventoryState& State : States)
+	{
+		if (State.Inventory == Inventory)
+		{
+			return &State;
+		}
+	}
+	
+	FInventoryState& State = States.AddDefaulted_GetRef();
+	State.Inventory = Inventory;
+	State.NumEntries = Inventory->InventoryEntries.GetEntriesCount();
+	return &State;
+}
+
+bool FInventoryTransaction::Fail(const TCHAR* Reason)
+{
+	UE_LOG(LogTemp, Log, TEXT("[InventoryTransaction] Aborted: %s"), Reason);
+	bFailed = true;
+	return false;
+}
+
+int32 FInventoryTransaction::GetProjectedQuantity(const FInventoryState& State, FInventoryItemHandle ItemHandle)
+{
+	if (const int32* Quantity = State.Quantities.Find(ItemHandle))
+	{
+		return *Quantity;
+	}
+	
+	const FInventoryEntry* Entry = State.Inventory->InventoryEntries.FindEntryByHandle(ItemHandle);
+	return Entry ? Entry->GetQuantity() : 0;
+}
+
+bool FInventoryTransaction::IsSlotInRange(const FInventoryState& State, int32 SlotIndex)
+{
+	const int32 MaxSlots = State.Inventory->GetMaxSlots();
+	return SlotIndex >= 0 && (MaxSlots <= 0 || SlotIndex < MaxSlots);
+}
+
+bool FInventoryTransaction::HasRoomForNewStack(const FInventoryState& State)
+{
+	const int32 MaxSlots = State.Inventory->GetMaxSlots();
+	return MaxSlots <= 0 || State.NumEntries < MaxSlots;
+}
+
+bool FInventoryTransaction::FindProjectedOccupant(const FInventoryState& State, int32 SlotIndex,
+	FInventoryItemHandle& OutHandle, int32& OutNewStackIndex)
+{
+	OutHandle.Invalidate();
+	OutNewStackIndex = INDEX_NONE;
+	
+	for (int32 NewStackIndex = 0; NewStackIndex < State.NewStacks.Num(); ++NewStackIndex)
+	{
+		if (State.NewStacks[NewStackIndex].SlotIndex == SlotIndex)
+		{
+			OutNewStackIndex = NewStackIndex;
+			return true;
+		}
+	}
+	
+	// Stacks moved into the slot
+	for (const TPair<FInventoryItemHandle, int32>& Moved : State.Slots)
+	{
+		if (Moved.Value == SlotIndex && GetProjectedQuantity(State, Moved.Key) > 0)
+		{
+			OutHandle = Moved.Key;
+			return true;
+		}
+	}
+	
+	// The current occupant, unless it moves away or runs out
+	const FInventoryEntry* Entry = State.Inventory->InventoryEntries.FindEntryBySlot(SlotIndex);
+	if (Entry && !State.Slots.Contains(Entry->GetHandle()) && GetProjectedQuantity(State, Entry->GetHandle()) > 0)
+	{
+		OutHandle = Entry->GetHandle();
+		return true;
+	}
+	
+	return false;
+}
+
+int32 FInventoryTransaction::FindProjectedFreeSlot(const FInventoryState& State)
+{
+	// Every occupied slot can push the answer up by one at most
+	const int32 MaxSlots = State.Inventory->GetMaxSlots();
+	const int32 NumCandidates = MaxSlots > 0
+		? MaxSlots
+		: State.Inventory->InventoryEntries.GetEntriesCount() + State.NewStacks.Num() + 1;
+	
+	FInventoryItemHandle Occupant;
+	int32 NewStackIndex;
+	for (int32 SlotIndex = 0; SlotIndex < NumCandidates; ++SlotIndex)
+	{
+		if (!FindProjectedOccupant(State, SlotIndex, Occupant, NewStackIndex))
+		{
+			return SlotIndex;
+		}
+	}
+	return INDEX_NONE;
+}
+
+int32 FInventoryTransaction::AddNewStack(FInventoryState& State, const UInventoryItemDefinition* ItemDef, int32 Quantity, int32 SlotIndex)
+{
+	FNewStack& NewStack = State.NewStacks.AddDefaulted_GetRef();
+	NewStack.ItemDef = ItemDef;
+	NewStack.Quantity = Quantity;
+	NewStack.SlotIndex = SlotIndex;
+	NewStack.Order = NumNewStacks++;
+	++State.NumEntries;
+	return State.NewStacks.Num() - 1;
+}
+
+bool FInventoryTransaction::StageRemove(UInventoryComponent* Inventory, FInventoryItemHandle ItemHandle, int32 Quantity)
+{
+	FInventoryState* State = FindOrAddState(Inventory);
+	if (!State) return false;
+	
+	const int32 Current = GetProjectedQuantity(*State, ItemHandle);
+	if (Quantity <= 0 || Current < Quantity)
+	{
+		return Fail(TEXT("not enough items to remove"));
+	}
+	
+	State->Quantities.Add(ItemHandle, Current - Quantity);
+	if (Current == Quantity)
+	{
+		--State->NumEntries;
+	}
+	return true;
+}
+
+bool FInventoryTransaction::StageAddToSlot(UInventoryComponent* Inventory, const UInventoryItemDefinition* ItemDef, int32 Quantity, int32 SlotIndex)
+{
+	FInventoryState* State = FindOrAddState(Inventory);
+	if (!State) return false;
+	
+	if (!ItemDef || Quantity <= 0) return Fail(TEXT("nothing to add"));
+	if (!Inventory->CanAcceptItemDefinition(ItemDef)) return Fail(TEXT("rejected by tag filter"));
+	
+	if (SlotIndex == INDEX_NONE)
+	{
+		SlotIndex = HasRoomForNewStack(*State) ? FindProjectedFreeSlot(*State) : INDEX_NONE;
+		if (SlotIndex == INDEX_NONE) return Fail(TEXT("no free slot"));
+	}
+	if (!IsSlotInRange(*State, SlotIndex)) return Fail(TEXT("slot out of range"));
+	
+	const FInventoryItemHotData& HotData = ItemDef->GetHotData();
+	const int32 StackSize = HotData.bStackable ? FMath::Max(1, HotData.MaxStackSize) : 1;
+	
+	FInventoryItemHandle Occupant;
+	int32 NewStackIndex;
+	if (!FindProjectedOccupant(*State, SlotIndex, Occupant, NewStackIndex))
+	{
+		if (Quantity > StackSize) return Fail(TEXT("quantity exceeds the stack size"));
+		if (!HasRoomForNewStack(*State)) return Fail(TEXT("no room for a new stack"));
+		
+		AddNewStack(*State, ItemDef, Quantity, SlotIndex);
+		return true;
+	}
+	
+	// Top up a matching stack
+	if (!HotData.bStackable) return Fail(TEXT("slot occupied"));
+	
+	if (NewStackIndex != INDEX_NONE)
+	{
+		FNewStack& NewStack = State->NewStacks[NewStackIndex];
+		if (NewStack.TransferSource || NewStack.ItemDef != ItemDef || NewStack.Quantity + Quantity > StackSize) return Fail(TEXT("slot occupied"));
+		
+		NewStack.Quantity += Quantity;
+		return true;
+	}
+	
+	const FInventoryEntry* Entry = Inventory->InventoryEntries.FindEntryByHandle(Occupant);
+	const int32 Current = GetProjectedQuantity(*State, Occupant);
+	if (!Entry || Entry->GetItemDefinition() != ItemDef || Current + Quantity > StackSize) return Fail(TEXT("slot occupied"));
+	
+	State->Quantities.Add(Occupant, Current + Quantity);
+	return true;
+}
+
+bool FInventoryTransaction::StageAdd(UInventoryComponent* Inventory, const UInventoryItemDefinition* ItemDef, int32 Quantity)
+{
+	FInventoryState* State = FindOrAddState(Inventory);
+	if (!State) return false;
+	
+	if (!ItemDef || Quantity <= 0) return Fail(TEXT("nothing to add"));
+	if (!Inventory->CanAcceptItemDefinition(ItemDef)) return Fail(TEXT("rejected by tag filter"));
+	
+	const FInventoryItemHotData& HotData = ItemDef->GetHotData();
+	const int32 StackSize = HotData.bStackable ? FMath::Max(1, HotData.MaxStackSize) : 1;
+	int32 Remaining = Quantity;
+	
+	// Top up the open stacks first, staged ones included
+	if (HotData.bStackable)
+	{
+		if (const TArray<int32>* OpenStacks = Inventory->InventoryEntries.FindOpenStacks(ItemDef))
+		{
+			const TArray<FInventoryEntry>& Entries = Inventory->InventoryEntries.GetAllEntriesRef();
+			for (const int32 Index : *OpenStacks)
+			{
+				if (Remaining <= 0) break;
+				
+				const FInventoryItemHandle Handle = Entries[Index].GetHandle();
+				const int32 Current = GetProjectedQuantity(*State, Handle);
+				if (Current <= 0) continue;
+				
+				const int32 ToAdd = FMath::Min(StackSize - Current, Remaining);
+				if (ToAdd <= 0) continue;
+				
+				State->Quantities.Add(Handle, Current + ToAdd);
+				Remaining -= ToAdd;
+			}
+		}
+		
+		for (FNewStack& NewStack : State->NewStacks)
+		{
+			if (Remaining <= 0) break;
+			if (NewStack.TransferSource || NewStack.ItemDef != ItemDef) continue;
+			
+			const int32 ToAdd = FMath::Min(StackSize - NewStack.Quantity, Remaining);
+			if (ToAdd <= 0) continue;
+			
+			NewStack.Quantity += ToAdd;
+			Remaining -= ToAdd;
+		}
+	}
+	
+	// Then new stacks
+	while (Remaining > 0)
+	{
+		const int32 SlotIndex = HasRoomForNewStack(*State) ? FindProjectedFreeSlot(*State) : INDEX_NONE;
+		if (SlotIndex == INDEX_NONE) return Fail(TEXT("no room for a new stack"));
+		
+		const int32 ToAdd = FMath::Min(Remaining, StackSize);
+		AddNewStack(*State, ItemDef, ToAdd, SlotIndex);
+		Remaining -= ToAdd;
+	}
+	
+	return true;
+}
+
+bool FInventoryTransaction::StageMoveToSlot(UInventoryComponent* Inventory, FInventoryItemHandle ItemHandle, int32 SlotIndex)
+{
+	FInventoryState* State = FindOrAddState(Inventory);
+	if (!State) return false;
+	
+	if (GetProjectedQuantity(*State, ItemHandle) <= 0) return Fail(TEXT("stack not found"));
+	
+	if (SlotIndex == INDEX_NONE)
+	{
+		SlotIndex = FindProjectedFreeSlot(*State);
+		if (SlotIndex == INDEX_NONE) return Fail(TEXT("no free slot"));
+	}
+	else
+	{
+		FInventoryItemHandle Occupant;
+		int32 NewStackIndex;
+		if (!IsSlotInRange(*State, SlotIndex)) return Fail(TEXT("slot out of range"));
+		if (FindProjectedOccupant(*State, SlotIndex, Occupant, NewStackIndex) && Occupant != ItemHandle) return Fail(TEXT("slot occupied"));
+	}
+	
+	State->Slots.Add(ItemHandle, SlotIndex);
+	return true;
+}
+
+const UInventoryItemDefinition* FInventoryTransaction::StageTransferOut(FInventoryState& State, FInventoryItemHandle ItemHandle, int32& OutSlotIndex)
+{
+	const FInventoryEntry* Entry = State.Inventory->InventoryEntries.FindEntryByHandle(ItemHandle);
+	if (!Entry || !Entry->GetItemDefinition() || State.Quantities.Contains(ItemHandle) || State.Slots.Contains(ItemHandle))
+	{
+		Fail(TEXT("stack not found or already staged"));
+		return nullptr;
+	}
+	
+	State.Quantities.Add(ItemHandle, 0);
+	--State.NumEntries;
+	OutSlotIndex = Entry->GetSlotIndex();
+	return Entry->GetItemDefinition();
+}
+
+bool FInventoryTransaction::StageTransferIn(FInventoryState& State, UInventoryComponent* Source, FInventoryItemHandle ItemHandle,
+	const UInventoryItemDefinition* ItemDef, int32 SlotIndex)
+{
+	if (!State.Inventory->CanAcceptItemDefinition(ItemDef)) return Fail(TEXT("rejected by tag filter"));
+	if (!IsSlotInRange(State, SlotIndex)) return Fail(TEXT("slot out of range"));
+	
+	FInventoryItemHandle Occupant;
+	int32 NewStackIndex;
+	if (FindProjectedOccupant(State, SlotIndex, Occupant, NewStackIndex)) return Fail(TEXT("slot occupied"));
+	if (!HasRoomForNewStack(State)) return Fail(TEXT("no room for a new stack"));
+	
+	FNewStack& NewStack = State.NewStacks[AddNewStack(State, ItemDef, 0, SlotIndex)];
+	NewStack.TransferSource = Source;
+	NewStack.TransferHandle = ItemHandle;
+	return true;
+}
+
+bool FInventoryTransaction::StageTransfer(UInventoryComponent* Source, FInventoryItemHandle ItemHandle, UInventoryComponent* Target, int32 TargetSlotIndex)
+{
+	if (Source == Target)
+	{
+		return StageMoveToSlot(Source, ItemHandle, TargetSlotIndex);
+	}
+	
+	FInventoryState* SourceState = FindOrAddState(Source);
+	if (!SourceState) return false;
+	
+	int32 SourceSlot;
+	const UInventoryItemDefinition* ItemDef = StageTransferOut(*SourceState, ItemHandle, SourceSlot);
+	if (!ItemDef) return false;
+	
+	FInventoryState* TargetState = FindOrAddState(Target);
+	return TargetState && StageTransferIn(*TargetState, Source, ItemHandle, ItemDef, TargetSlotIndex);
+}
+
+bool FInventoryTransaction::StageSwap(UInventoryComponent* InventoryA, FInventoryItemHandle HandleA, UInventoryComponent* InventoryB, FInventoryItemHandle HandleB)
+{
+	if (InventoryA == InventoryB)
+	{
+		// Same list: only the slots change
+		FInventoryState* State = FindOrAddState(InventoryA);
+		if (!State) return false;
+		
+		const FInventoryEntry* EntryA = InventoryA->InventoryEntries.FindEntryByHandle(HandleA);
+		const FInventoryEntry* EntryB = InventoryA->InventoryEntries.FindEntryByHandle(HandleB);
+		if (!EntryA || !EntryB || HandleA == HandleB
+			|| State->Quantities.Contains(HandleA) || State->Slots.Contains(HandleA)
+			|| State->Quantities.Contains(HandleB) || State->Slots.Contains(HandleB))
+		{
+			return Fail(TEXT("stack not found or already staged"));
+		}
+		
+		State->Slots.Add(HandleA, EntryB->GetSlotIndex());
+		State->Slots.Add(HandleB, EntryA->GetSlotIndex());
+		return true;
+	}
+	
+	// Both leave before either arrives, so each lands in the slot the other freed
+	int32 SlotA;
+	int32 SlotB;
+	FInventoryState* StateA = FindOrAddState(InventoryA);
+	const UInventoryItemDefinition* ItemDefA = StateA ? StageTransferOut(*StateA, HandleA, SlotA) : nullptr;
+	if (!ItemDefA) return false;
+	
+	FInventoryState* StateB = FindOrAddState(InventoryB);
+	const UInventoryItemDefinition* ItemDefB = StateB ? StageTransferOut(*StateB, HandleB, SlotB) : nullptr;
+	if (!ItemDefB) return false;
+	
+	// Adding StateB may have reallocated the states
+	StateA = FindOrAddState(InventoryA);
+	
+	return StageTransferIn(*StateB, InventoryA, HandleA, ItemDefA, SlotB)
+		&& StageTransferIn(*StateA, InventoryB, HandleB, ItemDefB, SlotA);
+}
+
+bool FInventoryTransaction::Commit()
+{
+	if (bFailed || bCommitted)
+	{
+		return false;
+	}
+	
+	// Instances first: the only step that can still fail, and it doesn't touch any inventory
+	for (FInventoryState& State : States)
+	{
+		for (FNewStack& NewStack : State.NewStacks)
+		{
+			// Transferred stacks keep their instance within the actor, elsewhere the state moves to a new one
+			if (NewStack.TransferSource && NewStack.TransferSource->GetOwner() == State.Inventory->GetOwner())
+			{
+				continue;
+			}
+			
+			if (!State.Inventory->CreateItemInstanceIfNeeded(NewStack.ItemDef, NewStack.Instance))
+			{
+				for (FInventoryState& CreatedState : States)
+				{
+					for (FNewStack& Created : CreatedState.NewStacks)
+					{
+						CreatedState.Inventory->RecycleItemInstance(Created.Instance);
+						Created.Instance = nullptr;
+					}
+				}
+				return Fail(TEXT("failed to create an item instance"));
+			}
+		}
+	}
+	
+	bCommitted = true;
+	CreatedHandles.SetNum(NumNewStacks);
+	
+	for (FInventoryState& State : States)
+	{
+		State.Inventory->BeginChangeScope();
+	}
+	
+	// Take every transferred record out before anything lands, a swap needs both slots free
+	TArray<FInventoryEntry> TransferredEntries;
+	TransferredEntries.SetNum(NumNewStacks);
+	for (const FInventoryState& State : States)
+	{
+		for (const FNewStack& NewStack : State.NewStacks)
+		{
+			if (NewStack.TransferSource)
+			{
+				NewStack.TransferSource->InventoryEntries.ExtractItem(NewStack.TransferHandle, TransferredEntries[NewStack.Order]);
+			}
+		}
+	}
+	
+	for (FInventoryState& State : States)
+	{
+		UInventoryComponent* Inventory = State.Inventory;
+		FInventoryList& Entries = Inventory->InventoryEntries;
+		
+		// Shrink and remove first, so the slots they free are available below
+		for (const TPair<FInventoryItemHandle, int32>& Quantity : State.Quantities)
+		{
+			const FInventoryEntry* Entry = Entries.FindEntryByHandle(Quantity.Key);
+			if (Entry && Quantity.Value < Entry->GetQuantity())
+			{
+				Entries.RemoveItem(Quantity.Key, Entry->GetQuantity() - Quantity.Value);
+			}
+		}
+		
+		for (const TPair<FInventoryItemHandle, int32>& Slot : State.Slots)
+		{
+			const int32 Index = Entries.IndexOfHandle(Slot.Key);
+			if (Index == INDEX_NONE) continue;
+			
+			Entries.SetEntrySlot(Index, Slot.Value);
+			Entries.MarkItemDirty(Entries.GetEntryByIndex(Index));
+			Inventory->PostInventoryItemChanged(Entries.GetEntryByIndex(Index));
+		}
+		
+		for (const TPair<FInventoryItemHandle, int32>& Quantity : State.Quantities)
+		{
+			const int32 Index = Entries.IndexOfHandle(Quantity.Key);
+			if (Index == INDEX_NONE || Quantity.Value <= Entries.GetEntryByIndex(Index).GetQuantity()) continue;
+			
+			Entries.SetEntryQuantity(Index, Quantity.Value);
+			Entries.MarkItemDirty(Entries.GetEntryByIndex(Index));
+			Inventory->PostInventoryItemChanged(Entries.GetEntryByIndex(Index));
+		}
+		
+		for (const FNewStack& NewStack : State.NewStacks)
+		{
+			if (!NewStack.TransferSource)
+			{
+				CreatedHandles[NewStack.Order] = Entries.AddItem(NewStack.ItemDef, NewStack.Instance, NewStack.Quantity, NewStack.SlotIndex);
+				continue;
+			}
+			
+			FInventoryEntry& Record = TransferredEntries[NewStack.Order];
+			UInventoryItemInstance* OldInstance = Record.ItemInstance;
+			if (NewStack.Instance)
+			{
+				// Another actor's channel: hand the state over, the old instance goes back to its pool
+				NewStack.Instance->CopyStateFrom(OldInstance);
+				NewStack.TransferSource->RecycleItemInstance(OldInstance);
+				Record.ItemInstance = NewStack.Instance;
+			}
+			else if (OldInstance)
+			{
+				// Same actor: the instance only switches to this component's subobject list
+				if (NewStack.TransferSource->IsUsingRegisteredSubObjectList())
+				{
+					NewStack.TransferSource->RemoveReplicatedSubObject(OldInstance);
+				}
+				if (Inventory->IsUsingRegisteredSubObjectList() && Inventory->IsReadyForReplication())
+				{
+					Inventory->AddReplicatedSubObject(OldInstance);
+				}
+			}
+			
+			CreatedHandles[NewStack.Order] = Entries.InsertItem(Record, NewStack.SlotIndex);
+		}
+	}
+	
+	// One dirty mark and one change set per inventory
+	for (FInventoryState& State : States)
+	{
+		State.Inventory->EndChangeScope();
+	}
+	
+	return true;
+}
@@ -2,11 +2,21 @@
 
 #include "ModularInventory.h"
 
+#include "Inventory/Fragments/ItemFragment_Stackable.h"
+#include "Inventory/Fragments/ItemFragment_UserInterface.h"
+#include "Inventory/Fragments/ItemFragment_WorldMesh.h"
+
 #define LOCTEXT_NAMESPACE "FModularInventoryModule"
 
 void FModularInventoryModule::StartupModule()
 {
 	// This code will execute after your module is loaded into memory; the exact timing is specified in the .uplugin file per-module
+	
+	// Register the built-in fragment types up front so item definitions loaded later
+	// bake them into their typed lookup table
+	FInventoryFragmentTypeRegistry::GetTypeIndex<UItemFragment_Stackable>();
+	FInventoryFragmentTypeRegistry::GetTypeIndex<UItemFragment_UserInterface>();
+	FInventoryFragmentTypeRegistry::GetTypeIndex<UItemFragment_WorldMesh>();
 }
 
 void FModularInventoryModule::ShutdownModule()
@@ -0,0 +1,40 @@
+﻿// Copyright Peter Gyarmati (BitroseStudio)
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Misc/AutomationTest.h"
+#include "Inventory/InventoryGameplayTags.h"
+#include "Tests/InventoryTestHelpers.h"
+
+using namespace InventoryTests;
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryAcceptQueryTest, "ModularInventory.Inventory.AcceptQuery",
+	MODULARINVENTORY_TEST_FLAGS)
+
+/** Runtime definitions match on their GameplayTags, and a tag rebuild invalidates the memoized answer. */
+bool FInventoryAcceptQueryTest::RunTest(const FString& Parameters)
+{
+	FTestWorld TestWorld;
+	UInventoryComponent* Inventory = TestWorld.SpawnInventory(4);
+	Inventory->SetAllowedItemTagQuery(FGameplayTagQuery::MakeQuery_MatchAnyTags(FGameplayTagContainer(ItemTagTypeWeapon)));
+	
+	const UInventoryItemDefinition* Sword = MakeItemDefinition(TEXT("Sword"), 1, FGameplayTagContainer(ItemTagTypeWeapon));
+	UInventoryItemDefinition* Stone = MakeItemDefinition(TEXT("Stone"), 10, FGameplayTagContainer(ItemTagTypeResource));
+	
+	TestTrue(TEXT("Weapon accepted"), Inventory->CanAcceptItemDefinition(Sword));
+	TestFalse(TEXT("Resource rejected"), Inventory->CanAcceptItemDefinition(Stone));
+	
+	// Retag at runtime: the cached rejection must not survive the rebuild
+	Stone->GameplayTags.AddTag(ItemTagTypeWeapon);
+	Stone->RebuildDynamicTags();
+	TestTrue(TEXT("Retagged definition accepted"), Inventory->CanAcceptItemDefinition(Stone));
+	
+	Stone->GameplayTags.RemoveTag(ItemTagTypeWeapon);
+	Stone->RebuildDynamicTags();
+	TestFalse(TEXT("Rejected again after removing the tag"), Inventory->CanAcceptItemDefinition(Stone));
+	TestFalse(TEXT("AddItem honors the query"), Inventory->AddItem(Stone, 1));
+	
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
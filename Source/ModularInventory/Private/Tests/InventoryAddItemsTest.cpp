@@ -0,0 +1,79 @@
+﻿// Copyright Peter Gyarmati (BitroseStudio)
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Misc/AutomationTest.h"
+#include "Inventory/InventoryGameplayTags.h"
+#include "Tests/InventoryTestHelpers.h"
+
+using namespace InventoryTests;
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryAddItemsTest, "ModularInventory.Inventory.AddItems",
+	MODULARINVENTORY_TEST_FLAGS)
+
+bool FInventoryAddItemsTest::RunTest(const FString& Parameters)
+{
+	FTestWorld TestWorld;
+	const UInventoryItemDefinition* Stone = MakeItemDefinition(TEXT("Stone"), 10);
+	const UInventoryItemDefinition* Sword = MakeItemDefinition(TEXT("Sword"), 1, FGameplayTagContainer(ItemTagTypeWeapon));
+	
+	// Requests for one definition are merged and top up the open stack first
+	{
+		UInventoryComponent* Inventory = TestWorld.SpawnInventory(3);
+		Inventory->AddItem(Stone, 5);
+		
+		int32 NumBroadcasts = 0;
+		Inventory->OnInventoryChangedNative.AddLambda([&NumBroadcasts](const FInventoryChangeSet&) { ++NumBroadcasts; });
+		
+		TArray<int32> Remainders;
+		const FItemAddRequest Requests[] = { { Stone, 7 }, { Sword, 1 }, { Stone, 4 } };
+		TestTrue(TEXT("Batch fits"), Inventory->AddItems(Requests, false, &Remainders));
+		TestEqual(TEXT("Stones added"), CountItems(Inventory, Stone), 16);
+		TestEqual(TEXT("Two stone stacks and the sword"), Inventory->GetInventoryEntries().GetEntriesCount(), 3);
+		TestEqual(TEXT("Remainders"), Remainders, TArray<int32>({ 0, 0, 0 }));
+		TestEqual(TEXT("One change set for the batch"), NumBroadcasts, 1);
+	}
+	
+	// All or nothing: a batch that doesn't fit adds nothing
+	{
+		UInventoryComponent* Inventory = TestWorld.SpawnInventory(2);
+		
+		TArray<int32> Remainders;
+		const FItemAddRequest Requests[] = { { Stone, 15 }, { Stone, 10 } };
+		TestFalse(TEXT("Batch does not fit"), Inventory->AddItems(Requests, true, &Remainders));
+		TestEqual(TEXT("Nothing added"), Inventory->GetInventoryEntries().GetEntriesCount(), 0);
+		TestEqual(TEXT("Everything remains"), Remainders, TArray<int32>({ 15, 10 }));
+	}
+	
+	// Partial: what fits goes in, the remainders go back to the requests in order
+	{
+		UInventoryComponent* Inventory = TestWorld.SpawnInventory(2);
+		
+		TArray<int32> Remainders;
+		const FItemAddRequest Requests[] = { { Stone, 15 }, { Stone, 10 } };
+		TestFalse(TEXT("Batch only fits partly"), Inventory->AddItems(Requests, false, &Remainders));
+		TestEqual(TEXT("Two full stacks"), CountItems(Inventory, Stone), 20);
+		TestEqual(TEXT("The later request keeps the remainder"), Remainders, TArray<int32>({ 0, 5 }));
+	}
+	
+	// The tag filter rejects the request, the rest still goes in
+	{
+		UInventoryComponent* Inventory = TestWorld.SpawnInventory(4);
+		Inventory->SetAllowedItemTagQuery(FGameplayTagQuery::MakeQuery_MatchAnyTags(FGameplayTagContainer(ItemTagTypeWeapon)));
+		
+		TArray<int32> Remainders;
+		const FItemAddRequest Requests[] = { { Stone, 3 }, { Sword, 1 } };
+		TestFalse(TEXT("Stone rejected"), Inventory->AddItems(Requests, false, &Remainders));
+		TestEqual(TEXT("Sword added"), CountItems(Inventory, Sword), 1);
+		TestEqual(TEXT("No stones"), CountItems(Inventory, Stone), 0);
+		TestEqual(TEXT("Remainders"), Remainders, TArray<int32>({ 3, 0 }));
+		
+		const FItemAddRequest AllOrNothing[] = { { Stone, 3 }, { Sword, 1 } };
+		TestFalse(TEXT("All or nothing with a rejected request"), Inventory->AddItems(AllOrNothing, true));
+		TestEqual(TEXT("Second sword not added"), CountItems(Inventory, Sword), 1);
+	}
+	
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,60 @@
+﻿// Copyright Peter Gyarmati (BitroseStudio)
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Misc/AutomationTest.h"
+#include "GameFramework/PlayerController.h"
+#include "Tests/InventoryTestHelpers.h"
+
+using namespace InventoryTests;
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryCommandAccessTest, "ModularInventory.Commands.Access",
+	MODULARINVENTORY_TEST_FLAGS)
+
+/** Players reach their own inventories and the containers they opened, nothing else. */
+bool FInventoryCommandAccessTest::RunTest(const FString& Parameters)
+{
+	FTestWorld TestWorld;
+	UWorld* World = TestWorld.GetWorld();
+	const UInventoryItemDefinition* Stone = MakeItemDefinition(TEXT("Stone"), 20);
+	
+	APlayerController* Player = World->SpawnActor<APlayerController>();
+	APlayerController* OtherPlayer = World->SpawnActor<APlayerController>();
+	UInventoryComponent* PlayerInventory = FTestWorld::AddInventory(Player, 8);
+	UInventoryComponent* OtherInventory = FTestWorld::AddInventory(OtherPlayer, 8);
+	UInventoryComponent* Chest = TestWorld.SpawnInventory(8);
+	Chest->AddItem(Stone, 10);
+	
+	// A generic container replicated to everyone is still not open to everyone
+	FBoolProperty* ViewersOnlyProperty = FindFProperty<FBoolProperty>(UInventoryComponent::StaticClass(), TEXT("bReplicateToViewersOnly"));
+	check(ViewersOnlyProperty);
+	ViewersOnlyProperty->SetPropertyValue_InContainer(OtherInventory, false);
+	
+	TestTrue(TEXT("Server callers are trusted"), Chest->CanBeAccessedBy(nullptr));
+	TestTrue(TEXT("Own inventory"), PlayerInventory->CanBeAccessedBy(Player));
+	TestFalse(TEXT("Another player's generic inventory"), OtherInventory->CanBeAccessedBy(Player));
+	TestFalse(TEXT("Unopened chest"), Chest->CanBeAccessedBy(Player));
+	
+	// Taking from a chest the player never opened is rejected on the server
+	const FInventoryItemHandle StoneHandle = GetHandleInSlot(Chest, 0);
+	PlayerInventory->SubmitCommand(FInventoryCommand::MakeTransfer(Chest, StoneHandle, PlayerInventory, 10, INDEX_NONE));
+	TestEqual(TEXT("Unopened chest keeps its stones"), CountItems(Chest, Stone), 10);
+	TestEqual(TEXT("Nothing taken"), CountItems(PlayerInventory, Stone), 0);
+	
+	Chest->AddViewer(Player);
+	TestTrue(TEXT("Opened chest"), Chest->CanBeAccessedBy(Player));
+	TestFalse(TEXT("Still closed for the other player"), Chest->CanBeAccessedBy(OtherPlayer));
+	PlayerInventory->SubmitCommand(FInventoryCommand::MakeTransfer(Chest, StoneHandle, PlayerInventory, 10, INDEX_NONE));
+	TestEqual(TEXT("Stones taken from the opened chest"), CountItems(PlayerInventory, Stone), 10);
+	
+	Chest->RemoveViewer(Player);
+	TestFalse(TEXT("Closed chest"), Chest->CanBeAccessedBy(Player));
+	
+	// Viewers of containers without viewer replication get access too
+	OtherInventory->AddViewer(Player);
+	TestTrue(TEXT("Viewer of a generic inventory"), OtherInventory->CanBeAccessedBy(Player));
+	
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,79 @@
+﻿// Copyright Peter Gyarmati (BitroseStudio)
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Misc/AutomationTest.h"
+#include "UObject/CoreNet.h"
+#include "Tests/InventoryTestHelpers.h"
+
+using namespace InventoryTests;
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryEntryNetSizeTest, "ModularInventory.Replication.EntryBytesPerUpdate",
+	MODULARINVENTORY_TEST_FLAGS)
+
+namespace
+{
+	/** Bits FInventoryEntry::NetSerialize writes for the entry. */
+	int64 MeasureEntryBits(UPackageMap* PackageMap, const FInventoryEntry& Entry, FInventoryEntry* OutReadBack = nullptr)
+	{
+		FNetBitWriter Writer(PackageMap, 1024);
+		bool bSuccess = true;
+		const_cast<FInventoryEntry&>(Entry).NetSerialize(Writer, PackageMap, bSuccess);
+		
+		if (OutReadBack)
+		{
+			FNetBitReader Reader(PackageMap, Writer.GetData(), Writer.GetNumBits());
+			OutReadBack->NetSerialize(Reader, PackageMap, bSuccess);
+		}
+		return Writer.GetNumBits();
+	}
+}
+
+/**
+ * Wire size of one entry update. The base package map writes no object references, so this is
+ * the entry's own payload; the definition and instance references add one NetGUID each, as before.
+ * The old layout sent a 16-byte Guid plus two int32s for the same data.
+ */
+bool FInventoryEntryNetSizeTest::RunTest(const FString& Parameters)
+{
+	constexpr int64 LegacyPayloadBits = (16 + 4 + 4) * 8;
+	
+	FTestWorld TestWorld;
+	UPackageMap* PackageMap = NewObject<UPackageMap>();
+	const UInventoryItemDefinition* Arrow = MakeItemDefinition(TEXT("Arrow"), 100000, FGameplayTagContainer(), true);
+	
+	UInventoryComponent* Inventory = TestWorld.SpawnInventory(600);
+	Inventory->AddItem(Arrow, 5);
+	const FInventoryItemHandle Handle = GetHandleInSlot(Inventory, 0);
+	FInventoryList& Entries = Inventory->GetInventoryEntries();
+	
+	// Typical update: a small stack in a low slot
+	FInventoryEntry ReadBack;
+	const int64 SmallBits = MeasureEntryBits(PackageMap, *Inventory->FindEntryByHandle(Handle), &ReadBack);
+	TestEqual(TEXT("Handle survives the round trip"), ReadBack.GetHandle(), Handle);
+	TestEqual(TEXT("Quantity survives the round trip"), ReadBack.GetQuantity(), 5);
+	TestEqual(TEXT("Slot survives the round trip"), ReadBack.GetSlotIndex(), 0);
+	
+	// Quantity tick: the entry is resent, still in a few bytes
+	const int32 Index = Entries.IndexOfHandle(Handle);
+	Entries.SetEntryQuantity(Index, 6);
+	const int64 TickBits = MeasureEntryBits(PackageMap, Entries.GetEntryByIndex(Index));
+	
+	// Worst realistic case: a huge stack in a high slot
+	Inventory->MoveItemByHandle(Handle, 599);
+	Entries.SetEntryQuantity(Entries.IndexOfHandle(Handle), 99999);
+	const int64 LargeBits = MeasureEntryBits(PackageMap, *Inventory->FindEntryByHandle(Handle), &ReadBack);
+	TestEqual(TEXT("Large quantity survives the round trip"), ReadBack.GetQuantity(), 99999);
+	TestEqual(TEXT("High slot survives the round trip"), ReadBack.GetSlotIndex(), 599);
+	
+	AddInfo(FString::Printf(TEXT("Entry update: %lld bits typical, %lld bits quantity tick, %lld bits large (legacy %lld bits)"),
+		SmallBits, TickBits, LargeBits, LegacyPayloadBits));
+	
+	TestTrue(TEXT("Typical update fits in 5 bytes"), SmallBits <= 5 * 8);
+	TestTrue(TEXT("Quantity tick fits in 5 bytes"), TickBits <= 5 * 8);
+	TestTrue(TEXT("Large update stays under half the legacy size"), LargeBits * 2 <= LegacyPayloadBits);
+	
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,126 @@
+﻿// Copyright Peter Gyarmati (BitroseStudio)
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Misc/AutomationTest.h"
+#include "HAL/PlatformTime.h"
+#include "Inventory/Fragments/ItemFragment_UserInterface.h"
+#include "Inventory/Fragments/ItemFragment_WorldMesh.h"
+#include "Tests/InventoryTestHelpers.h"
+
+using namespace InventoryTests;
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryFragmentLookupBenchmark, "ModularInventory.Performance.FragmentLookup",
+	MODULARINVENTORY_PERF_TEST_FLAGS)
+
+/**
+ * Typed fragment lookup (one array read) against the IsA loop it replaced, on definitions
+ * with 1 to 16 fragments. The looked-up fragment is always the last one, the loop's worst case.
+ */
+bool FInventoryFragmentLookupBenchmark::RunTest(const FString& Parameters)
+{
+	constexpr int32 NumLookups = 500000;
+	
+	for (int32 NumFragments = 1; NumFragments <= 16; NumFragments *= 2)
+	{
+		UInventoryItemDefinition* ItemDef = MakeItemDefinition(TEXT("FragmentItem"), 1);
+		for (int32 Index = 0; Index < NumFragments - 1; ++Index)
+		{
+			if (Index % 2 == 0)
+			{
+				ItemDef->Fragments.Add(NewObject<UItemFragment_UserInterface>(ItemDef));
+			}
+			else
+			{
+				ItemDef->Fragments.Add(NewObject<UItemFragment_WorldMesh>(ItemDef));
+			}
+		}
+		UItemFragment_Stackable* Target = NewObject<UItemFragment_Stackable>(ItemDef);
+		ItemDef->Fragments.Add(Target);
+		ItemDef->RebuildFragmentCache();
+		
+		int32 NumFound = 0;
+		const double LoopStart = FPlatformTime::Seconds();
+		for (int32 Lookup = 0; Lookup < NumLookups; ++Lookup)
+		{
+			for (const UInventoryItemFragment* Fragment : ItemDef->Fragments)
+			{
+				if (Fragment && Fragment->IsA(UItemFragment_Stackable::StaticClass()))
+				{
+					NumFound += Fragment == Target;
+					break;
+				}
+			}
+		}
+		const double LoopCost = (FPlatformTime::Seconds() - LoopStart) * 1e9 / NumLookups;
+		
+		const double ClassStart = FPlatformTime::Seconds();
+		for (int32 Lookup = 0; Lookup < NumLookups; ++Lookup)
+		{
+			NumFound += ItemDef->FindFragmentByClass(UItemFragment_Stackable::StaticClass()) == Target;
+		}
+		const double ClassCost = (FPlatformTime::Seconds() - ClassStart) * 1e9 / NumLookups;
+		
+		const double TypedStart = FPlatformTime::Seconds();
+		for (int32 Lookup = 0; Lookup < NumLookups; ++Lookup)
+		{
+			NumFound += ItemDef->FindFragmentByClass<UItemFragment_Stackable>() == Target;
+		}
+		const double TypedCost = (FPlatformTime::Seconds() - TypedStart) * 1e9 / NumLookups;
+		
+		TestEqual(FString::Printf(TEXT("%d fragments: every path finds the fragment"), NumFragments), NumFound, NumLookups * 3);
+		AddInfo(FString::Printf(TEXT("%2d fragments: IsA loop %.2f ns, class map %.2f ns, typed %.2f ns"),
+			NumFragments, LoopCost, ClassCost, TypedCost));
+	}
+	
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryFragmentLookupTest, "ModularInventory.Definition.FragmentLookup",
+	MODULARINVENTORY_TEST_FLAGS)
+
+/** The cached lookups answer like the IsA loop: parent classes match, missing fragments don't. */
+bool FInventoryFragmentLookupTest::RunTest(const FString& Parameters)
+{
+	UInventoryItemDefinition* ItemDef = MakeItemDefinition(TEXT("FragmentItem"), 5);
+	const UInventoryItemFragment* Stackable = ItemDef->Fragments[0];
+	
+	TestTrue(TEXT("Typed lookup finds the fragment"), ItemDef->FindFragmentByClass<UItemFragment_Stackable>() == Stackable);
+	TestTrue(TEXT("Parent class matches too"), ItemDef->FindFragmentByClass(UInventoryItemFragment::StaticClass()) == Stackable);
+	TestNull(TEXT("Missing fragment"), ItemDef->FindFragmentByClass<UItemFragment_WorldMesh>());
+	
+	TestTrue(TEXT("Hot data baked from the fragment"), ItemDef->GetHotData().bStackable);
+	TestEqual(TEXT("Hot data stack size"), ItemDef->GetHotData().MaxStackSize, 5);
+	
+	// Changing the fragments at runtime needs the documented rebuild
+	ItemDef->Fragments.Add(NewObject<UItemFragment_WorldMesh>(ItemDef));
+	ItemDef->RebuildFragmentCache();
+	TestNotNull(TEXT("Added fragment found after the rebuild"), ItemDef->FindFragmentByClass<UItemFragment_WorldMesh>());
+	
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryRuntimeDefinitionTest, "ModularInventory.Definition.RuntimeDefinition",
+	MODULARINVENTORY_TEST_FLAGS)
+
+/** A definition made with NewObject never runs PostLoad but still stacks and honors bInstanceless. */
+bool FInventoryRuntimeDefinitionTest::RunTest(const FString& Parameters)
+{
+	FTestWorld TestWorld;
+	UInventoryComponent* Inventory = TestWorld.SpawnInventory(4);
+	
+	const UInventoryItemDefinition* Stone = MakeItemDefinition(TEXT("Stone"), 10, FGameplayTagContainer(), true);
+	TestTrue(TEXT("Stackable on first use"), Stone->GetHotData().bStackable);
+	TestEqual(TEXT("Stack size on first use"), Stone->GetHotData().MaxStackSize, 10);
+	TestFalse(TEXT("Instance-less on first use"), Stone->GetHotData().bNeedsInstance);
+	
+	TestTrue(TEXT("Add 15 stones"), Inventory->AddItem(Stone, 15));
+	TestEqual(TEXT("Two stacks"), Inventory->GetInventoryEntries().GetEntriesCount(), 2);
+	const FInventoryEntry* Entry = Inventory->FindEntryBySlot(0);
+	TestTrue(TEXT("Full first stack"), Entry && Entry->GetQuantity() == 10);
+	TestTrue(TEXT("No instance created"), Entry && !Entry->IsItemInstanceValid());
+	
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,88 @@
+﻿// Copyright Peter Gyarmati (BitroseStudio)
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Misc/AutomationTest.h"
+#include "HAL/PlatformTime.h"
+#include "Math/RandomStream.h"
+#include "Tests/InventoryTestHelpers.h"
+
+using namespace InventoryTests;
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryHandleLookupBenchmark, "ModularInventory.Performance.HandleLookup",
+	MODULARINVENTORY_PERF_TEST_FLAGS)
+
+/**
+ * Handle -> entry lookups must cost the same from 10 to 10,000 stacks.
+ * The linear scan the lookups replaced is timed alongside for reference.
+ */
+bool FInventoryHandleLookupBenchmark::RunTest(const FString& Parameters)
+{
+	constexpr int32 NumLookups = 200000;
+	constexpr int32 NumLinearLookups = 2000;
+	const int32 Sizes[] = { 10, 100, 1000, 10000 };
+	
+	FTestWorld TestWorld;
+	// One stack per item: instance-less keeps the setup cheap, lookups don't touch instances
+	const UInventoryItemDefinition* ItemDef = MakeItemDefinition(TEXT("LookupItem"), 1, FGameplayTagContainer(), true);
+	
+	double SmallestCost = 0.0;
+	double LargestCost = 0.0;
+	
+	for (const int32 Size : Sizes)
+	{
+		UInventoryComponent* Inventory = TestWorld.SpawnInventory(Size);
+		if (!Inventory->AddItem(ItemDef, Size))
+		{
+			AddError(FString::Printf(TEXT("Could not fill an inventory of %d stacks"), Size));
+			return false;
+		}
+		
+		TArray<FInventoryItemHandle> Handles;
+		for (const FInventoryEntry& Entry : Inventory->GetInventoryEntries().GetAllEntriesRef())
+		{
+			Handles.Add(Entry.GetHandle());
+		}
+		
+		// Random order, so the large sizes can't ride the cache line by line
+		FRandomStream Rng(Size);
+		TArray<int32> Order;
+		Order.SetNumUninitialized(NumLookups);
+		for (int32& Index : Order)
+		{
+			Index = Rng.RandRange(0, Handles.Num() - 1);
+		}
+		
+		int64 Checksum = 0;
+		const double HandleStart = FPlatformTime::Seconds();
+		for (const int32 Index : Order)
+		{
+			const FInventoryEntry* Entry = Inventory->FindEntryByHandle(Handles[Index]);
+			Checksum += Entry ? Entry->GetQuantity() : -1;
+		}
+		const double HandleCost = (FPlatformTime::Seconds() - HandleStart) * 1e9 / NumLookups;
+		
+		const TArray<FInventoryEntry>& Entries = Inventory->GetInventoryEntries().GetAllEntriesRef();
+		const double LinearStart = FPlatformTime::Seconds();
+		for (int32 LookupIndex = 0; LookupIndex < NumLinearLookups; ++LookupIndex)
+		{
+			const FInventoryItemHandle Handle = Handles[Order[LookupIndex]];
+			Checksum += Entries.IndexOfByPredicate([Handle](const FInventoryEntry& Entry) { return Entry.GetHandle() == Handle; });
+		}
+		const double LinearCost = (FPlatformTime::Seconds() - LinearStart) * 1e9 / NumLinearLookups;
+		
+		TestEqual(TEXT("Every handle resolves"), Inventory->GetInventoryEntries().GetEntriesCount(), Size);
+		AddInfo(FString::Printf(TEXT("%5d stacks: handle lookup %.1f ns, linear scan %.1f ns (checksum %lld)"),
+			Size, HandleCost, LinearCost, Checksum));
+		
+		if (Size == Sizes[0]) SmallestCost = HandleCost;
+		LargestCost = HandleCost;
+	}
+	
+	// A scan grows 1000x over this range. Leave room for cache misses on the large lists
+	TestTrue(TEXT("Handle lookup cost stays flat from 10 to 10,000 stacks"), LargestCost <= SmallestCost * 4.0 + 50.0);
+	
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,73 @@
+﻿// Copyright Peter Gyarmati (BitroseStudio)
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Misc/AutomationTest.h"
+#include "HAL/PlatformTime.h"
+#include "Tests/InventoryTestHelpers.h"
+
+using namespace InventoryTests;
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryIdleContainersBenchmark, "ModularInventory.Performance.IdleContainers",
+	MODULARINVENTORY_PERF_TEST_FLAGS)
+
+/**
+ * 5,000 filled, idle containers on the server. The net driver only compares a push-based
+ * property after it was marked dirty, and a fast array whose replication key did not move
+ * serializes nothing, so an idle container must leave both untouched frame after frame.
+ * Reports the server frame cost with the containers alive.
+ */
+bool FInventoryIdleContainersBenchmark::RunTest(const FString& Parameters)
+{
+	constexpr int32 NumContainers = 5000;
+	constexpr int32 NumFrames = 120;
+	
+	FTestWorld TestWorld;
+	const UInventoryItemDefinition* Stone = MakeItemDefinition(TEXT("Stone"), 50);
+	const UInventoryItemDefinition* Sword = MakeItemDefinition(TEXT("Sword"), 1);
+	
+	TArray<UInventoryComponent*> Containers;
+	TArray<int32> ReplicationKeys;
+	Containers.Reserve(NumContainers);
+	ReplicationKeys.Reserve(NumContainers);
+	for (int32 Index = 0; Index < NumContainers; ++Index)
+	{
+		UInventoryComponent* Container = TestWorld.SpawnInventory(16);
+		Container->GetOwner()->SetReplicates(true);
+		Container->AddItem(Stone, 120);
+		Container->AddItem(Sword, 2);
+		Containers.Add(Container);
+	}
+	
+	// Let the adds settle (pending timers, change scopes) before sampling the keys
+	UWorld* World = TestWorld.GetWorld();
+	World->Tick(LEVELTICK_All, 1.0f / 60.0f);
+	for (const UInventoryComponent* Container : Containers)
+	{
+		ReplicationKeys.Add(Container->GetInventoryEntries().ArrayReplicationKey);
+	}
+	
+	double WorstFrame = 0.0;
+	const double Start = FPlatformTime::Seconds();
+	for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+	{
+		const double FrameStart = FPlatformTime::Seconds();
+		World->Tick(LEVELTICK_All, 1.0f / 60.0f);
+		WorstFrame = FMath::Max(WorstFrame, FPlatformTime::Seconds() - FrameStart);
+	}
+	const double FrameCost = (FPlatformTime::Seconds() - Start) * 1e3 / NumFrames;
+	
+	int32 NumDirtied = 0;
+	for (int32 Index = 0; Index < NumContainers; ++Index)
+	{
+		NumDirtied += Containers[Index]->GetInventoryEntries().ArrayReplicationKey != ReplicationKeys[Index];
+	}
+	
+	AddInfo(FString::Printf(TEXT("%d idle containers: %.3f ms per server frame, worst %.3f ms, %d dirtied while idle"),
+		NumContainers, FrameCost, WorstFrame * 1e3, NumDirtied));
+	TestEqual(TEXT("Idle containers never dirty their entries"), NumDirtied, 0);
+	
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
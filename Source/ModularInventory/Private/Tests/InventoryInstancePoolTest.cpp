@@ -0,0 +1,106 @@
+﻿// Copyright Peter Gyarmati (BitroseStudio)
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Misc/AutomationTest.h"
+#include "HAL/PlatformTime.h"
+#include "Inventory/InventoryItemInstancePool.h"
+#include "Tests/InventoryTestHelpers.h"
+
+using namespace InventoryTests;
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryInstancePoolStressTest, "ModularInventory.Performance.InstancePoolDragSplit",
+	MODULARINVENTORY_PERF_TEST_FLAGS)
+
+/**
+ * A rapid drag/split session: split a stack, merge it back, many times over.
+ * With the pool the whole session lives on the instances of the first split.
+ */
+bool FInventoryInstancePoolStressTest::RunTest(const FString& Parameters)
+{
+	constexpr int32 NumCycles = 5000;
+	
+	FTestWorld TestWorld;
+	const UInventoryItemDefinition* Arrow = MakeItemDefinition(TEXT("Arrow"), 100);
+	UInventoryComponent* Inventory = TestWorld.SpawnInventory(8);
+	Inventory->AddItem(Arrow, 50);
+	const FInventoryItemHandle SourceHandle = GetHandleInSlot(Inventory, 0);
+	
+	const int32 ObjectsBefore = GUObjectArray.GetObjectArrayNumMinusAvailable();
+	const double Start = FPlatformTime::Seconds();
+	double WorstCycle = 0.0;
+	
+	for (int32 Cycle = 0; Cycle < NumCycles; ++Cycle)
+	{
+		const double CycleStart = FPlatformTime::Seconds();
+		
+		FInventoryItemHandle SplitHandle;
+		if (!Inventory->SplitItemStackForDrag(SourceHandle, 10, SplitHandle)
+			|| !Inventory->MoveItemByHandle(SplitHandle, 0))
+		{
+			AddError(FString::Printf(TEXT("Split/merge failed in cycle %d"), Cycle));
+			return false;
+		}
+		
+		WorstCycle = FMath::Max(WorstCycle, FPlatformTime::Seconds() - CycleStart);
+	}
+	
+	const double Total = FPlatformTime::Seconds() - Start;
+	const int32 ObjectsCreated = GUObjectArray.GetObjectArrayNumMinusAvailable() - ObjectsBefore;
+	
+	AddInfo(FString::Printf(TEXT("%d split/merge cycles: %.2f us per cycle, worst %.2f us, %d UObjects allocated"),
+		NumCycles, Total * 1e6 / NumCycles, WorstCycle * 1e6, ObjectsCreated));
+	
+	TestEqual(TEXT("All arrows back in one stack"), GetQuantity(Inventory, SourceHandle), 50);
+	TestEqual(TEXT("One stack left"), Inventory->GetInventoryEntries().GetEntriesCount(), 1);
+	// Each merge recycles the split's instance, the next split picks it up again
+	TestTrue(TEXT("Split stacks reuse pooled instances"), ObjectsCreated <= 2);
+	
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryInstancePoolTest, "ModularInventory.Inventory.InstancePool",
+	MODULARINVENTORY_TEST_FLAGS)
+
+/** Instances only go back to the actor that outers them, and leave the pool with it. */
+bool FInventoryInstancePoolTest::RunTest(const FString& Parameters)
+{
+	FTestWorld TestWorld;
+	UInventoryItemInstancePool* Pool = UInventoryItemInstancePool::Get(TestWorld.GetWorld());
+	if (!TestNotNull(TEXT("Pool exists in game worlds"), Pool))
+	{
+		return false;
+	}
+	
+	const UInventoryItemDefinition* Sword = MakeItemDefinition(TEXT("Sword"), 1);
+	UInventoryComponent* InventoryA = TestWorld.SpawnInventory(4);
+	UInventoryComponent* InventoryB = TestWorld.SpawnInventory(4);
+	
+	InventoryA->AddItem(Sword, 1);
+	const FInventoryItemHandle Handle = GetHandleInSlot(InventoryA, 0);
+	const UInventoryItemInstance* Released = InventoryA->FindEntryByHandle(Handle)->GetItemInstance();
+	InventoryA->RemoveItem(Handle, 1);
+	TestEqual(TEXT("Removed stack's instance pooled"), Pool->GetNumPooled(), 1);
+	
+	// Another actor can't take it, its instances live on a different channel
+	InventoryB->AddItem(Sword, 1);
+	TestEqual(TEXT("Other owner allocates"), Pool->GetNumPooled(), 1);
+	TestTrue(TEXT("Other owner got a new instance"), GetHandleInSlot(InventoryB, 0).IsValid()
+		&& InventoryB->FindEntryBySlot(0)->GetItemInstance() != Released);
+	
+	// Same owner reuses it
+	InventoryA->AddItem(Sword, 1);
+	TestTrue(TEXT("Same owner reuses the pooled instance"), InventoryA->FindEntryBySlot(0)->GetItemInstance() == Released);
+	TestEqual(TEXT("Pool empty again"), Pool->GetNumPooled(), 0);
+	
+	// Instances of destroyed actors are dropped
+	InventoryA->RemoveItem(GetHandleInSlot(InventoryA, 0), 1);
+	TestEqual(TEXT("Pooled again"), Pool->GetNumPooled(), 1);
+	InventoryA->GetOwner()->Destroy();
+	Pool->PruneDeadOwners();
+	TestEqual(TEXT("Dead owner's instances pruned"), Pool->GetNumPooled(), 0);
+	
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
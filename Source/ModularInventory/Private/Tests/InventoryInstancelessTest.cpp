@@ -0,0 +1,71 @@
+﻿// Copyright Peter Gyarmati (BitroseStudio)
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Misc/AutomationTest.h"
+#include "HAL/PlatformTime.h"
+#include "UObject/UObjectGlobals.h"
+#include "Tests/InventoryTestHelpers.h"
+
+using namespace InventoryTests;
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryInstancelessBenchmark, "ModularInventory.Performance.InstancelessStacks",
+	MODULARINVENTORY_PERF_TEST_FLAGS)
+
+/**
+ * Fills the same number of stacks with an instanced and an instance-less definition, and
+ * reports the UObjects each allocated and the CollectGarbage time with those stacks alive.
+ */
+bool FInventoryInstancelessBenchmark::RunTest(const FString& Parameters)
+{
+	constexpr int32 NumStacks = 5000;
+	constexpr int32 StackSize = 10;
+	constexpr int32 NumGCPasses = 5;
+	
+	for (const bool bInstanceless : { false, true })
+	{
+		FTestWorld TestWorld;
+		UInventoryComponent* Inventory = TestWorld.SpawnInventory(NumStacks);
+		UInventoryItemDefinition* Resource = MakeItemDefinition(
+			bInstanceless ? TEXT("InstancelessResource") : TEXT("InstancedResource"), StackSize, FGameplayTagContainer(), bInstanceless);
+		// Nothing references the definition until the stacks exist
+		Resource->AddToRoot();
+		
+		// Settle whatever the world setup left behind so the passes below only walk the inventory
+		CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+		
+		const int32 ObjectsBefore = GUObjectArray.GetObjectArrayNumMinusAvailable();
+		if (!TestTrue(TEXT("Inventory filled"), Inventory->AddItem(Resource, NumStacks * StackSize)))
+		{
+			return false;
+		}
+		const int32 ObjectsCreated = GUObjectArray.GetObjectArrayNumMinusAvailable() - ObjectsBefore;
+		TestEqual(TEXT("One stack per slot"), Inventory->GetInventoryEntries().GetEntriesCount(), NumStacks);
+		
+		const double GCStart = FPlatformTime::Seconds();
+		for (int32 Pass = 0; Pass < NumGCPasses; ++Pass)
+		{
+			CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+		}
+		const double GCCost = (FPlatformTime::Seconds() - GCStart) * 1e3 / NumGCPasses;
+		
+		AddInfo(FString::Printf(TEXT("%s: %d stacks, %d UObjects allocated, CollectGarbage %.3f ms"),
+			bInstanceless ? TEXT("Instance-less") : TEXT("Instanced"), NumStacks, ObjectsCreated, GCCost));
+		
+		if (bInstanceless)
+		{
+			TestEqual(TEXT("Instance-less stacks allocate no UObjects"), ObjectsCreated, 0);
+		}
+		else
+		{
+			TestTrue(TEXT("Instanced stacks allocate one instance each"), ObjectsCreated >= NumStacks);
+		}
+		TestEqual(TEXT("Stacks survive GC"), CountItems(Inventory, Resource), NumStacks * StackSize);
+		
+		Resource->RemoveFromRoot();
+	}
+	
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,81 @@
+﻿// Copyright Peter Gyarmati (BitroseStudio)
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Misc/AutomationTest.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "Tests/InventoryTestHelpers.h"
+
+using namespace InventoryTests;
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryItemHandleTest, "ModularInventory.Inventory.ItemHandles",
+	MODULARINVENTORY_TEST_FLAGS)
+
+bool FInventoryItemHandleTest::RunTest(const FString& Parameters)
+{
+	FTestWorld TestWorld;
+	const UInventoryItemDefinition* Sword = MakeItemDefinition(TEXT("Sword"), 1);
+	const UInventoryItemDefinition* Shield = MakeItemDefinition(TEXT("Shield"), 1);
+	UInventoryComponent* Inventory = TestWorld.SpawnInventory(4);
+	
+	Inventory->AddItem(Sword, 1);
+	Inventory->AddItem(Shield, 1);
+	const FInventoryItemHandle SwordHandle = GetHandleInSlot(Inventory, 0);
+	const FInventoryItemHandle ShieldHandle = GetHandleInSlot(Inventory, 1);
+	TestTrue(TEXT("Handles are valid"), SwordHandle.IsValid() && ShieldHandle.IsValid());
+	TestNotEqual(TEXT("Handles are unique"), SwordHandle, ShieldHandle);
+	
+	// Handles follow their stack, not the slot
+	TestTrue(TEXT("Swap"), Inventory->MoveItemByHandle(SwordHandle, 1));
+	TestEqual(TEXT("Sword moved"), Inventory->FindEntryByHandle(SwordHandle)->GetSlotIndex(), 1);
+	TestEqual(TEXT("Shield moved"), Inventory->FindEntryByHandle(ShieldHandle)->GetSlotIndex(), 0);
+	
+	// The persistent Guid is assigned on demand and stays put
+	const FGuid Guid = Inventory->GetOrCreatePersistentGuid(SwordHandle);
+	TestTrue(TEXT("Guid assigned"), Guid.IsValid());
+	TestEqual(TEXT("Guid stable"), Inventory->GetOrCreatePersistentGuid(SwordHandle), Guid);
+	
+	// A removed stack's handle index is reused with the next generation
+	TestTrue(TEXT("Remove sword"), Inventory->RemoveItem(SwordHandle, 1));
+	TestNull(TEXT("Removed handle no longer resolves"), Inventory->FindEntryByHandle(SwordHandle));
+	
+	Inventory->AddItem(Sword, 1);
+	const FInventoryItemHandle NewHandle = GetHandleInSlot(Inventory, 1);
+	TestEqual(TEXT("Index reused"), NewHandle.GetIndex(), SwordHandle.GetIndex());
+	TestNotEqual(TEXT("Generation bumped"), NewHandle.GetGeneration(), SwordHandle.GetGeneration());
+	TestNull(TEXT("Stale handle doesn't resolve to the new stack"), Inventory->FindEntryByHandle(SwordHandle));
+	TestNotNull(TEXT("New handle resolves"), Inventory->FindEntryByHandle(NewHandle));
+	TestFalse(TEXT("New stack has no Guid yet"), Inventory->FindEntryByHandle(NewHandle)->GetItemGuid().IsValid());
+	
+	// Wire format
+	{
+		TArray<uint8> Bytes;
+		FMemoryWriter Writer(Bytes);
+		FInventoryItemHandle Written = NewHandle;
+		Written.SerializePacked(Writer);
+		
+		FMemoryReader Reader(Bytes);
+		FInventoryItemHandle Read;
+		Read.SerializePacked(Reader);
+		TestEqual(TEXT("Handle round trip"), Read, NewHandle);
+	}
+	{
+		// Generation 0 is never issued, a forged one reads as invalid
+		TArray<uint8> Bytes;
+		FMemoryWriter Writer(Bytes);
+		uint32 Index = 3;
+		uint32 Generation = 0;
+		Writer.SerializeIntPacked(Index);
+		Writer.SerializeIntPacked(Generation);
+		
+		FMemoryReader Reader(Bytes);
+		FInventoryItemHandle Read;
+		Read.SerializePacked(Reader);
+		TestFalse(TEXT("Generation 0 rejected"), Read.IsValid());
+	}
+	
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,97 @@
+﻿// Copyright Peter Gyarmati (BitroseStudio)
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Misc/AutomationTest.h"
+#include "HAL/PlatformTime.h"
+#include "Blueprint/UserWidget.h"
+#include "Components/UniformGridPanel.h"
+#include "UI/Widgets/InventoryPanelWidget.h"
+#include "UI/Widgets/InventorySlotWidget.h"
+#include "Tests/InventoryTestHelpers.h"
+
+using namespace InventoryTests;
+
+namespace
+{
+	UInventorySlotWidget* GetSlotWidget(const UInventoryPanelWidget* Panel, int32 SlotIndex)
+	{
+		return Cast<UInventorySlotWidget>(Panel->ItemsPanel->GetChildAt(SlotIndex));
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryPanelQuantityTickBenchmark, "ModularInventory.Performance.PanelQuantityTick",
+	MODULARINVENTORY_PERF_TEST_FLAGS)
+
+/**
+ * Panel over a full 40-slot inventory: cost of HandleInventoryChanged for one quantity change,
+ * against the full RebuildFromInventory it replaced. Only the changed slot's widget may be touched.
+ */
+bool FInventoryPanelQuantityTickBenchmark::RunTest(const FString& Parameters)
+{
+	constexpr int32 NumSlots = 40;
+	constexpr int32 NumTicks = 20000;
+	
+	FTestWorld TestWorld;
+	UInventoryComponent* Inventory = TestWorld.SpawnInventory(NumSlots);
+	const UInventoryItemDefinition* Stone = MakeItemDefinition(TEXT("Stone"), 100);
+	
+	// 39 full stacks, the last one half full so a single stone changes only its quantity
+	Inventory->AddItem(Stone, 100 * (NumSlots - 1) + 50);
+	TestEqual(TEXT("Every slot filled"), Inventory->GetInventoryEntries().GetEntriesCount(), NumSlots);
+	const int32 TickSlot = NumSlots - 1;
+	
+	UInventoryPanelWidget* Panel = CreateWidget<UInventoryPanelWidget>(TestWorld.GetWorld());
+	if (!TestNotNull(TEXT("Panel created"), Panel))
+	{
+		return false;
+	}
+	Panel->ItemsPanel = NewObject<UUniformGridPanel>(Panel);
+	Panel->SlotWidgetClass = UInventorySlotWidget::StaticClass();
+	Panel->InitializeWithInventory(Inventory);
+	TestEqual(TEXT("One widget per slot"), Panel->ItemsPanel->GetChildrenCount(), NumSlots);
+	
+	// Forget every slot's index, the handler restores it on the slots it refreshes
+	for (int32 SlotIndex = 0; SlotIndex < NumSlots; ++SlotIndex)
+	{
+		GetSlotWidget(Panel, SlotIndex)->SlotIndex = INDEX_NONE;
+	}
+	
+	TestTrue(TEXT("Quantity tick"), Inventory->AddItem(Stone, 1));
+	
+	int32 NumTouched = 0;
+	for (int32 SlotIndex = 0; SlotIndex < NumSlots; ++SlotIndex)
+	{
+		NumTouched += GetSlotWidget(Panel, SlotIndex)->SlotIndex != INDEX_NONE;
+	}
+	TestEqual(TEXT("Only the dirty slot widget is touched"), NumTouched, 1);
+	const UInventorySlotWidget* TickWidget = GetSlotWidget(Panel, TickSlot);
+	TestEqual(TEXT("The dirty slot is refreshed"), TickWidget->SlotIndex, TickSlot);
+	TestEqual(TEXT("With the new quantity"), TickWidget->ItemData.GetQuantity(), 51);
+	
+	// Same change set the component broadcasts for one quantity change, replayed to the panel only
+	FInventoryChangeSet ChangeSet;
+	ChangeSet.Changed.Add(*Inventory->FindEntryBySlot(TickSlot));
+	
+	const double TickStart = FPlatformTime::Seconds();
+	for (int32 Tick = 0; Tick < NumTicks; ++Tick)
+	{
+		Inventory->OnInventoryChangedNative.Broadcast(ChangeSet);
+	}
+	const double TickCost = (FPlatformTime::Seconds() - TickStart) * 1e6 / NumTicks;
+	
+	const double RebuildStart = FPlatformTime::Seconds();
+	for (int32 Tick = 0; Tick < NumTicks; ++Tick)
+	{
+		Panel->RebuildFromInventory();
+	}
+	const double RebuildCost = (FPlatformTime::Seconds() - RebuildStart) * 1e6 / NumTicks;
+	
+	AddInfo(FString::Printf(TEXT("%d slots, one quantity change: dirty-slot refresh %.3f us, full rebuild %.3f us"),
+		NumSlots, TickCost, RebuildCost));
+	
+	Panel->RemoveFromParent();
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,117 @@
+﻿// Copyright Peter Gyarmati (BitroseStudio)
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Misc/AutomationTest.h"
+#include "Tests/InventoryTestHelpers.h"
+
+using namespace InventoryTests;
+
+namespace
+{
+	/**
+	 * Stands in for the replication system on a client: the server's entries land first
+	 * (MoveServerEntry), the processed sequence follows with its OnRep, as under packet lag.
+	 */
+	class FSimulatedClient
+	{
+	public:
+		explicit FSimulatedClient(UInventoryComponent* InInventory)
+			: Inventory(InInventory)
+		{
+			SequenceProperty = FindFProperty<FUInt32Property>(UInventoryComponent::StaticClass(), TEXT("LastProcessedCommandSequence"));
+			check(SequenceProperty);
+			
+			// The command flush never runs: the test world is not ticked, so nothing reaches a server
+			Inventory->GetOwner()->SetRole(ROLE_AutonomousProxy);
+			
+			Inventory->OnPredictedSlotsChanged.AddLambda([this](const TArray<int32>& SlotIndices)
+			{
+				TArray<int32> Sorted = SlotIndices;
+				Sorted.Sort();
+				Broadcasts.Add(MoveTemp(Sorted));
+			});
+		}
+		
+		/** The server's result for an entry replicated in. */
+		void MoveServerEntry(FInventoryItemHandle Handle, int32 SlotIndex)
+		{
+			FInventoryList& Entries = Inventory->GetInventoryEntries();
+			Entries.SetEntrySlot(Entries.IndexOfHandle(Handle), SlotIndex);
+		}
+		
+		/** LastProcessedCommandSequence arriving, late or not. */
+		void ReceiveProcessedSequence(uint32 Sequence)
+		{
+			SequenceProperty->SetPropertyValue_InContainer(Inventory, Sequence);
+			Inventory->ProcessEvent(Inventory->FindFunctionChecked(TEXT("OnRep_LastProcessedCommandSequence")), nullptr);
+		}
+		
+		TArray<TArray<int32>> Broadcasts;
+		
+	private:
+		UInventoryComponent* Inventory;
+		FUInt32Property* SequenceProperty = nullptr;
+	};
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryPredictionLatencyTest, "ModularInventory.Commands.PredictionLatency",
+	MODULARINVENTORY_TEST_FLAGS)
+
+/**
+ * Two predicted moves under latency: a stale sequence update keeps both predictions, a
+ * mispredicted result rolls its slots back to the server's state, and each reconciliation
+ * only refreshes the slots its prediction named.
+ */
+bool FInventoryPredictionLatencyTest::RunTest(const FString& Parameters)
+{
+	FTestWorld TestWorld;
+	const UInventoryItemDefinition* Stone = MakeItemDefinition(TEXT("Stone"), 20);
+	const UInventoryItemDefinition* Sword = MakeItemDefinition(TEXT("Sword"), 1);
+	
+	UInventoryComponent* Inventory = TestWorld.SpawnInventory(8);
+	Inventory->AddItem(Stone, 10);
+	Inventory->AddItem(Sword, 1);
+	const FInventoryItemHandle StoneHandle = GetHandleInSlot(Inventory, 0);
+	const FInventoryItemHandle SwordHandle = GetHandleInSlot(Inventory, 1);
+	
+	FSimulatedClient Client(Inventory);
+	
+	const uint32 StoneMove = Inventory->SubmitCommand(FInventoryCommand::MakeMove(Inventory, StoneHandle, 4));
+	const uint32 SwordMove = Inventory->SubmitCommand(FInventoryCommand::MakeMove(Inventory, SwordHandle, 5));
+	TestTrue(TEXT("Commands sequenced"), StoneMove == 1 && SwordMove == 2);
+	
+	TestTrue(TEXT("Stone shown in its target slot"), Inventory->FindDisplayedEntryBySlot(4) && Inventory->FindDisplayedEntryBySlot(4)->GetHandle() == StoneHandle);
+	TestNull(TEXT("Stone's old slot shown empty"), Inventory->FindDisplayedEntryBySlot(0));
+	TestTrue(TEXT("Sword shown in its target slot"), Inventory->FindDisplayedEntryBySlot(5) && Inventory->FindDisplayedEntryBySlot(5)->GetHandle() == SwordHandle);
+	TestTrue(TEXT("Each prediction named its two slots"), Client.Broadcasts.Num() == 2
+		&& Client.Broadcasts[0] == TArray<int32>({ 0, 4 }) && Client.Broadcasts[1] == TArray<int32>({ 1, 5 }));
+	
+	// An update sent before the server got the batch: nothing is answered yet
+	Client.Broadcasts.Reset();
+	Client.ReceiveProcessedSequence(0);
+	TestEqual(TEXT("Stale sequence broadcasts nothing"), Client.Broadcasts.Num(), 0);
+	TestTrue(TEXT("Stone still predicted"), Inventory->IsSlotPredicted(4));
+	
+	// The server put the stone elsewhere (slot 4 got taken meanwhile): the prediction was wrong
+	Client.MoveServerEntry(StoneHandle, 6);
+	Client.ReceiveProcessedSequence(StoneMove);
+	TestTrue(TEXT("Only the stone's predicted slots refresh"), Client.Broadcasts.Num() == 1 && Client.Broadcasts[0] == TArray<int32>({ 0, 4 }));
+	TestNull(TEXT("Mispredicted slot rolled back"), Inventory->FindDisplayedEntryBySlot(4));
+	TestNull(TEXT("Old slot stays empty"), Inventory->FindDisplayedEntryBySlot(0));
+	TestTrue(TEXT("Stone shown where the server put it"), Inventory->FindDisplayedEntryBySlot(6) && Inventory->FindDisplayedEntryBySlot(6)->GetHandle() == StoneHandle);
+	TestTrue(TEXT("Later prediction survives"), Inventory->IsSlotPredicted(5)
+		&& Inventory->FindDisplayedEntryBySlot(5) && Inventory->FindDisplayedEntryBySlot(5)->GetHandle() == SwordHandle);
+	
+	// The sword move is confirmed as predicted
+	Client.Broadcasts.Reset();
+	Client.MoveServerEntry(SwordHandle, 5);
+	Client.ReceiveProcessedSequence(SwordMove);
+	TestTrue(TEXT("Only the sword's predicted slots refresh"), Client.Broadcasts.Num() == 1 && Client.Broadcasts[0] == TArray<int32>({ 1, 5 }));
+	TestFalse(TEXT("No predictions left"), Inventory->IsSlotPredicted(1) || Inventory->IsSlotPredicted(5));
+	TestTrue(TEXT("Sword shown from the replicated entry"), Inventory->FindDisplayedEntryBySlot(5) && Inventory->FindDisplayedEntryBySlot(5)->GetHandle() == SwordHandle);
+	
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
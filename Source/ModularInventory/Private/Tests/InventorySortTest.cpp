@@ -0,0 +1,109 @@
+﻿// Copyright Peter Gyarmati (BitroseStudio)
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Misc/AutomationTest.h"
+#include "UObject/CoreNet.h"
+#include "Inventory/InventoryGameplayTags.h"
+#include "Tests/InventoryTestHelpers.h"
+
+using namespace InventoryTests;
+
+namespace
+{
+	void SetSortCategoryParentTag(UInventoryComponent* Inventory, const FGameplayTag& ParentTag)
+	{
+		// Config property, only editable on the component's defaults
+		FStructProperty* Property = FindFProperty<FStructProperty>(UInventoryComponent::StaticClass(), TEXT("SortCategoryParentTag"));
+		check(Property);
+		*Property->ContainerPtrToValuePtr<FGameplayTag>(Inventory) = ParentTag;
+	}
+	
+	const UInventoryItemDefinition* GetDefinitionInSlot(const UInventoryComponent* Inventory, int32 SlotIndex)
+	{
+		const FInventoryEntry* Entry = Inventory->FindEntryBySlot(SlotIndex);
+		return Entry ? Entry->GetItemDefinition() : nullptr;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventorySortTest, "ModularInventory.Inventory.SortAndConsolidate",
+	MODULARINVENTORY_TEST_FLAGS)
+
+bool FInventorySortTest::RunTest(const FString& Parameters)
+{
+	FTestWorld TestWorld;
+	
+	FGameplayTagContainer SwordTags;
+	SwordTags.AddTag(ItemTagTypeWeapon);
+	SwordTags.AddTag(ItemTagTraitStackable);
+	
+	const UInventoryItemDefinition* Junk = MakeItemDefinition(TEXT("Junk"), 1);
+	const UInventoryItemDefinition* Sword = MakeItemDefinition(TEXT("Sword"), 1, SwordTags);
+	const UInventoryItemDefinition* Stone = MakeItemDefinition(TEXT("Stone"), 10, FGameplayTagContainer(ItemTagTypeResource));
+	const UInventoryItemDefinition* Pick = MakeItemDefinition(TEXT("Pick"), 1, FGameplayTagContainer(ItemTagTypeTool));
+	
+	UInventoryComponent* Inventory = TestWorld.SpawnInventory(8);
+	Inventory->AddItem(Junk, 1);
+	Inventory->AddItem(Sword, 1);
+	Inventory->AddItem(Stone, 7);
+	Inventory->AddItem(Pick, 1);
+	TestTrue(TEXT("Split the stones into two partial stacks"), Inventory->SplitItemStack(GetHandleInSlot(Inventory, 2), 3));
+	TestEqual(TEXT("Five stacks before sorting"), Inventory->GetInventoryEntries().GetEntriesCount(), 5);
+	
+	int32 NumBroadcasts = 0;
+	Inventory->OnInventoryChangedNative.AddLambda([&NumBroadcasts](const FInventoryChangeSet&) { ++NumBroadcasts; });
+	
+	// Category under Inventory.Item.Type: the sword's trait tag sorts lower but isn't a category
+	SetSortCategoryParentTag(Inventory, ItemTagType);
+	TestTrue(TEXT("Sort by category"), Inventory->SortAndConsolidate(EInventorySortKey::Category));
+	TestEqual(TEXT("One change set"), NumBroadcasts, 1);
+	TestEqual(TEXT("Stones consolidated"), Inventory->GetInventoryEntries().GetEntriesCount(), 4);
+	TestEqual(TEXT("Stone stack"), Inventory->FindEntryBySlot(0) ? Inventory->FindEntryBySlot(0)->GetQuantity() : 0, 7);
+	TestTrue(TEXT("Resource first"), GetDefinitionInSlot(Inventory, 0) == Stone);
+	TestTrue(TEXT("Then tool"), GetDefinitionInSlot(Inventory, 1) == Pick);
+	TestTrue(TEXT("Then weapon"), GetDefinitionInSlot(Inventory, 2) == Sword);
+	TestTrue(TEXT("Untagged last"), GetDefinitionInSlot(Inventory, 3) == Junk);
+	
+	// No parent: the lexically smallest tag, here the sword's trait
+	SetSortCategoryParentTag(Inventory, FGameplayTag());
+	Inventory->SortAndConsolidate(EInventorySortKey::Category);
+	TestTrue(TEXT("Without a parent the trait tag decides"), GetDefinitionInSlot(Inventory, 0) == Sword);
+	TestTrue(TEXT("Untagged still last"), GetDefinitionInSlot(Inventory, 3) == Junk);
+	
+	// Largest stacks first, submitted as a command
+	Inventory->SubmitCommand(FInventoryCommand::MakeSort(Inventory, EInventorySortKey::Quantity));
+	TestTrue(TEXT("Sort command carries its key"), GetDefinitionInSlot(Inventory, 0) == Stone);
+	
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventorySortCommandNetTest, "ModularInventory.Replication.SortCommand",
+	MODULARINVENTORY_TEST_FLAGS)
+
+/** The sort key has its own field and only goes on the wire for Sort commands. */
+bool FInventorySortCommandNetTest::RunTest(const FString& Parameters)
+{
+	UPackageMap* PackageMap = NewObject<UPackageMap>();
+	bool bSuccess = true;
+	
+	FInventoryCommand Sort = FInventoryCommand::MakeSort(nullptr, EInventorySortKey::DisplayName);
+	TestEqual(TEXT("Quantity unused by Sort"), Sort.Quantity, -1);
+	
+	FNetBitWriter SortWriter(PackageMap, 256);
+	Sort.NetSerialize(SortWriter, PackageMap, bSuccess);
+	
+	FInventoryCommand ReadBack;
+	FNetBitReader Reader(PackageMap, SortWriter.GetData(), SortWriter.GetNumBits());
+	ReadBack.NetSerialize(Reader, PackageMap, bSuccess);
+	TestEqual(TEXT("Type round trip"), ReadBack.Type, EInventoryCommandType::Sort);
+	TestEqual(TEXT("Sort key round trip"), ReadBack.SortKey, EInventorySortKey::DisplayName);
+	
+	FInventoryCommand Split = FInventoryCommand::MakeSplit(nullptr, FInventoryItemHandle(), -1);
+	FNetBitWriter SplitWriter(PackageMap, 256);
+	Split.NetSerialize(SplitWriter, PackageMap, bSuccess);
+	TestEqual(TEXT("Other commands don't send the key"), SortWriter.GetNumBits() - SplitWriter.GetNumBits(), int64(2));
+	
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,57 @@
+﻿// Copyright Peter Gyarmati (BitroseStudio)
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Misc/AutomationTest.h"
+#include "Actors/InventoryStorageActor.h"
+#include "GameFramework/PlayerController.h"
+#include "Tests/InventoryTestHelpers.h"
+
+using namespace InventoryTests;
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryStorageDormancyTest, "ModularInventory.Replication.StorageDormancy",
+	MODULARINVENTORY_TEST_FLAGS)
+
+/**
+ * Opening a dormant storage changes no entry, yet the viewer must get the contents: the
+ * actor has to leave dormancy so the viewer's channel opens with the current state.
+ */
+bool FInventoryStorageDormancyTest::RunTest(const FString& Parameters)
+{
+	FTestWorld TestWorld;
+	UWorld* World = TestWorld.GetWorld();
+	const UInventoryItemDefinition* Stone = MakeItemDefinition(TEXT("Stone"), 20);
+	
+	AInventoryStorageActor* Storage = World->SpawnActor<AInventoryStorageActor>();
+	UInventoryComponent* Inventory = Storage ? Storage->FindComponentByClass<UInventoryComponent>() : nullptr;
+	if (!TestNotNull(TEXT("Storage inventory"), Inventory))
+	{
+		return false;
+	}
+	TestEqual(TEXT("Starts dormant"), Storage->NetDormancy.GetValue(), DORM_Initial);
+	
+	// Filled while nobody watches, then the idle timer puts it back to sleep
+	Inventory->AddItem(Stone, 30);
+	Storage->SetNetDormancy(DORM_DormantAll);
+	
+	APlayerController* Viewer = World->SpawnActor<APlayerController>();
+	Inventory->AddViewer(Viewer);
+	TestTrue(TEXT("Viewer added"), Inventory->IsViewer(Viewer));
+	TestEqual(TEXT("Opening wakes the storage"), Storage->NetDormancy.GetValue(), DORM_Awake);
+	TestEqual(TEXT("Contents untouched"), CountItems(Inventory, Stone), 30);
+	
+	// Closing also has to reach the network: the viewer leaves the group
+	Storage->SetNetDormancy(DORM_DormantAll);
+	Inventory->RemoveViewer(Viewer);
+	TestFalse(TEXT("Viewer removed"), Inventory->IsViewer(Viewer));
+	TestEqual(TEXT("Closing wakes the storage"), Storage->NetDormancy.GetValue(), DORM_Awake);
+	
+	// A storage nobody ever changed is still initially dormant when first opened
+	AInventoryStorageActor* Untouched = World->SpawnActor<AInventoryStorageActor>();
+	Untouched->FindComponentByClass<UInventoryComponent>()->AddViewer(Viewer);
+	TestEqual(TEXT("Opening an initially dormant storage wakes it"), Untouched->NetDormancy.GetValue(), DORM_Awake);
+	
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,122 @@
+﻿// Copyright Peter Gyarmati (BitroseStudio)
+
+#pragma once
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "CoreMinimal.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "DataAssets/InventoryItemDefinition.h"
+#include "Inventory/InventoryComponent.h"
+#include "Inventory/Fragments/ItemFragment_Stackable.h"
+
+// Behavior tests run with the product tests, benchmarks only when perf tests are requested
+#define MODULARINVENTORY_TEST_FLAGS (EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+#define MODULARINVENTORY_PERF_TEST_FLAGS (EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+namespace InventoryTests
+{
+	/**
+	 * Standalone game world for one test. Its actors have authority, so the server paths
+	 * (AddItems, transactions, the instance pool) run as they would on a dedicated server.
+	 */
+	class FTestWorld
+	{
+	public:
+		FTestWorld()
+		{
+			World = UWorld::CreateWorld(EWorldType::Game, false, TEXT("InventoryTestWorld"));
+			FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+			WorldContext.SetCurrentWorld(World);
+			World->InitializeActorsForPlay(FURL());
+			World->BeginPlay();
+		}
+		
+		~FTestWorld()
+		{
+			GEngine->DestroyWorldContext(World);
+			World->DestroyWorld(false);
+		}
+		
+		UE_NONCOPYABLE(FTestWorld);
+		
+		UWorld* GetWorld() const { return World; }
+		
+		/** New inventory on its own actor. */
+		UInventoryComponent* SpawnInventory(int32 MaxSlots)
+		{
+			AActor* Owner = World->SpawnActor<AActor>();
+			return AddInventory(Owner, MaxSlots);
+		}
+		
+		/** New inventory on an existing actor, e.g. a second container of the same owner. */
+		static UInventoryComponent* AddInventory(AActor* Owner, int32 MaxSlots)
+		{
+			UInventoryComponent* Inventory = NewObject<UInventoryComponent>(Owner);
+			Inventory->RegisterComponent();
+			Inventory->SetMaxSlots(MaxSlots);
+			return Inventory;
+		}
+		
+	private:
+		UWorld* World = nullptr;
+	};
+	
+	/**
+	 * Transient definition: stackable up to MaxStackSize when above 1, with the given static tags.
+	 * Nothing is rebuilt by hand, the definition bakes its caches on first use like any runtime definition.
+	 */
+	inline UInventoryItemDefinition* MakeItemDefinition(const TCHAR* Name, int32 MaxStackSize,
+		const FGameplayTagContainer& Tags = FGameplayTagContainer(), bool bInstanceless = false)
+	{
+		UPackage* Package = GetTransientPackage();
+		UInventoryItemDefinition* ItemDef = NewObject<UInventoryItemDefinition>(Package,
+			MakeUniqueObjectName(Package, UInventoryItemDefinition::StaticClass(), Name), RF_Transient);
+		ItemDef->GameplayTags = Tags;
+		ItemDef->bInstanceless = bInstanceless;
+		
+		if (MaxStackSize > 1)
+		{
+			// MaxStackLimit is only editable on assets
+			UItemFragment_Stackable* Stackable = NewObject<UItemFragment_Stackable>(ItemDef);
+			FIntProperty* LimitProperty = FindFProperty<FIntProperty>(UItemFragment_Stackable::StaticClass(), TEXT("MaxStackLimit"));
+			check(LimitProperty);
+			LimitProperty->SetPropertyValue_InContainer(Stackable, MaxStackSize);
+			ItemDef->Fragments.Add(Stackable);
+		}
+		
+		return ItemDef;
+	}
+	
+	/** Quantity of the stack, 0 if the handle no longer resolves. */
+	inline int32 GetQuantity(const UInventoryComponent* Inventory, FInventoryItemHandle Handle)
+	{
+		const FInventoryEntry* Entry = Inventory->FindEntryByHandle(Handle);
+		return Entry ? Entry->GetQuantity() : 0;
+	}
+	
+	/** Handle of the stack in the slot, invalid if the slot is empty. */
+	inline FInventoryItemHandle GetHandleInSlot(const UInventoryComponent* Inventory, int32 SlotIndex)
+	{
+		const FInventoryEntry* Entry = Inventory->FindEntryBySlot(SlotIndex);
+		return Entry ? Entry->GetHandle() : FInventoryItemHandle();
+	}
+	
+	/** Total quantity of ItemDef across every stack. */
+	inline int32 CountItems(UInventoryComponent* Inventory, const UInventoryItemDefinition* ItemDef)
+	{
+		int32 Total = 0;
+		for (const FInventoryEntry& Entry : Inventory->GetInventoryEntries().GetAllEntriesRef())
+		{
+			if (Entry.GetItemDefinition() == ItemDef)
+			{
+				Total += Entry.GetQuantity();
+			}
+		}
+		return Total;
+	}
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
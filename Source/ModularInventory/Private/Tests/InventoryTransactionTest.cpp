@@ -0,0 +1,258 @@
+﻿// Copyright Peter Gyarmati (BitroseStudio)
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Misc/AutomationTest.h"
+#include "Inventory/InventoryGameplayTags.h"
+#include "Inventory/InventoryTransaction.h"
+#include "Tests/InventoryTestHelpers.h"
+
+using namespace InventoryTests;
+
+namespace
+{
+	/** Counts the change sets an inventory broadcasts. */
+	struct FBroadcastCounter
+	{
+		explicit FBroadcastCounter(UInventoryComponent* InInventory)
+			: Inventory(InInventory)
+		{
+			Handle = Inventory->OnInventoryChangedNative.AddLambda([this](const FInventoryChangeSet&) { ++Count; });
+		}
+		
+		~FBroadcastCounter()
+		{
+			Inventory->OnInventoryChangedNative.Remove(Handle);
+		}
+		
+		UInventoryComponent* Inventory;
+		FDelegateHandle Handle;
+		int32 Count = 0;
+	};
+	
+	/** Contents of an inventory as "definition x quantity @ slot", for before/after comparisons. */
+	TArray<FString> Snapshot(UInventoryComponent* Inventory)
+	{
+		TArray<FString> Lines;
+		for (const FInventoryEntry& Entry : Inventory->GetInventoryEntries().GetAllEntriesRef())
+		{
+			Lines.Add(FString::Printf(TEXT("%s x%d @%d"), *GetNameSafe(Entry.GetItemDefinition()), Entry.GetQuantity(), Entry.GetSlotIndex()));
+		}
+		Lines.Sort();
+		return Lines;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryTransactionFailedStageTest, "ModularInventory.Transaction.FailedStageTouchesNothing",
+	MODULARINVENTORY_TEST_FLAGS)
+
+bool FInventoryTransactionFailedStageTest::RunTest(const FString& Parameters)
+{
+	FTestWorld TestWorld;
+	const UInventoryItemDefinition* Stone = MakeItemDefinition(TEXT("Stone"), 10);
+	const UInventoryItemDefinition* Sword = MakeItemDefinition(TEXT("Sword"), 1);
+	
+	UInventoryComponent* Source = TestWorld.SpawnInventory(4);
+	UInventoryComponent* Target = TestWorld.SpawnInventory(1);
+	Source->AddItem(Stone, 10);
+	Target->AddItem(Sword, 1);
+	const TArray<FString> SourceBefore = Snapshot(Source);
+	const TArray<FString> TargetBefore = Snapshot(Target);
+	
+	FBroadcastCounter SourceBroadcasts(Source);
+	FBroadcastCounter TargetBroadcasts(Target);
+	
+	FInventoryTransaction Transaction;
+	TestTrue(TEXT("Remove stages"), Transaction.StageRemove(Source, GetHandleInSlot(Source, 0), 5));
+	TestFalse(TEXT("Add to a full inventory fails"), Transaction.StageAdd(Target, Stone, 5));
+	TestFalse(TEXT("Transaction poisoned"), Transaction.IsValid());
+	TestFalse(TEXT("Later stages fail too"), Transaction.StageRemove(Source, GetHandleInSlot(Source, 0), 1));
+	TestFalse(TEXT("Commit refuses"), Transaction.Commit());
+	
+	TestEqual(TEXT("Source untouched"), Snapshot(Source), SourceBefore);
+	TestEqual(TEXT("Target untouched"), Snapshot(Target), TargetBefore);
+	TestEqual(TEXT("No source broadcast"), SourceBroadcasts.Count, 0);
+	TestEqual(TEXT("No target broadcast"), TargetBroadcasts.Count, 0);
+	
+	// A split with no free slot is a failed stage as well and keeps the whole stack
+	UInventoryComponent* Full = TestWorld.SpawnInventory(1);
+	Full->AddItem(Stone, 10);
+	FInventoryItemHandle NewStack;
+	TestFalse(TEXT("Split without a free slot fails"), Full->SplitItemStackForDrag(GetHandleInSlot(Full, 0), 4, NewStack));
+	TestEqual(TEXT("Split quantity not lost"), CountItems(Full, Stone), 10);
+	TestFalse(TEXT("No new stack handle"), NewStack.IsValid());
+	
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryTransactionSwapTest, "ModularInventory.Transaction.SwapAcrossInventoriesWithTagFilters",
+	MODULARINVENTORY_TEST_FLAGS)
+
+bool FInventoryTransactionSwapTest::RunTest(const FString& Parameters)
+{
+	FTestWorld TestWorld;
+	const UInventoryItemDefinition* Sword = MakeItemDefinition(TEXT("Sword"), 1, FGameplayTagContainer(ItemTagTypeWeapon));
+	const UInventoryItemDefinition* Bow = MakeItemDefinition(TEXT("Bow"), 1, FGameplayTagContainer(ItemTagTypeWeapon));
+	const UInventoryItemDefinition* Stone = MakeItemDefinition(TEXT("Stone"), 10, FGameplayTagContainer(ItemTagTypeResource));
+	
+	UInventoryComponent* Backpack = TestWorld.SpawnInventory(4);
+	UInventoryComponent* WeaponRack = TestWorld.SpawnInventory(2);
+	WeaponRack->SetAllowedItemTagQuery(FGameplayTagQuery::MakeQuery_MatchAnyTags(FGameplayTagContainer(ItemTagTypeWeapon)));
+	
+	Backpack->AddItem(Stone, 6);
+	Backpack->AddItem(Sword, 1);
+	WeaponRack->AddItem(Bow, 1);
+	const FInventoryItemHandle StoneHandle = GetHandleInSlot(Backpack, 0);
+	const FInventoryItemHandle SwordHandle = GetHandleInSlot(Backpack, 1);
+	const FInventoryItemHandle BowHandle = GetHandleInSlot(WeaponRack, 0);
+	const UInventoryItemInstance* SwordInstance = Backpack->FindEntryByHandle(SwordHandle)->GetItemInstance();
+	
+	// The rack rejects stone: neither side changes
+	{
+		const TArray<FString> BackpackBefore = Snapshot(Backpack);
+		const TArray<FString> RackBefore = Snapshot(WeaponRack);
+		
+		FInventoryTransaction Transaction;
+		TestFalse(TEXT("Stone can't go into the rack"), Transaction.StageSwap(Backpack, StoneHandle, WeaponRack, BowHandle));
+		TestFalse(TEXT("Commit refuses"), Transaction.Commit());
+		TestEqual(TEXT("Backpack untouched"), Snapshot(Backpack), BackpackBefore);
+		TestEqual(TEXT("Rack untouched"), Snapshot(WeaponRack), RackBefore);
+	}
+	
+	// Weapon for weapon: each lands in the slot the other left
+	{
+		FInventoryTransaction Transaction;
+		TestTrue(TEXT("Swap stages"), Transaction.StageSwap(Backpack, SwordHandle, WeaponRack, BowHandle));
+		TestTrue(TEXT("Swap commits"), Transaction.Commit());
+		
+		const TArray<FInventoryItemHandle>& Created = Transaction.GetCreatedHandles();
+		TestEqual(TEXT("Two transferred stacks"), Created.Num(), 2);
+		
+		const FInventoryEntry* RackSword = WeaponRack->FindEntryBySlot(0);
+		const FInventoryEntry* BackpackBow = Backpack->FindEntryBySlot(1);
+		TestTrue(TEXT("Sword in the rack's slot 0"), RackSword && RackSword->GetItemDefinition() == Sword);
+		TestTrue(TEXT("Bow in the backpack's slot 1"), BackpackBow && BackpackBow->GetItemDefinition() == Bow);
+		TestEqual(TEXT("Stone stays"), CountItems(Backpack, Stone), 6);
+		TestNull(TEXT("Old sword handle is stale"), Backpack->FindEntryByHandle(SwordHandle));
+		
+		// Different actors: the state moves to an instance of the rack's actor
+		TestTrue(TEXT("Sword instance outered to the rack's actor"), RackSword && RackSword->GetItemInstance()
+			&& RackSword->GetItemInstance() != SwordInstance
+			&& RackSword->GetItemInstance()->GetOuter() == WeaponRack->GetOwner());
+	}
+	
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryTransactionTransferFullTest, "ModularInventory.Transaction.TransferIntoFullInventory",
+	MODULARINVENTORY_TEST_FLAGS)
+
+bool FInventoryTransactionTransferFullTest::RunTest(const FString& Parameters)
+{
+	FTestWorld TestWorld;
+	const UInventoryItemDefinition* Sword = MakeItemDefinition(TEXT("Sword"), 1);
+	const UInventoryItemDefinition* Stone = MakeItemDefinition(TEXT("Stone"), 10);
+	
+	UInventoryComponent* Source = TestWorld.SpawnInventory(4);
+	UInventoryComponent* Full = TestWorld.SpawnInventory(2);
+	Source->AddItem(Sword, 1);
+	Full->AddItem(Stone, 10);
+	Full->AddItem(Stone, 3);
+	const FInventoryItemHandle SwordHandle = GetHandleInSlot(Source, 0);
+	const TArray<FString> FullBefore = Snapshot(Full);
+	
+	FInventoryTransaction Transaction;
+	TestFalse(TEXT("No free slot to transfer into"), Transaction.StageTransfer(Source, SwordHandle, Full, 1));
+	TestFalse(TEXT("Commit refuses"), Transaction.Commit());
+	TestFalse(TEXT("MoveItemToInventory refuses too"), Source->MoveItemToInventory(Full, SwordHandle));
+	
+	TestEqual(TEXT("Sword stays"), GetQuantity(Source, SwordHandle), 1);
+	TestEqual(TEXT("Full inventory untouched"), Snapshot(Full), FullBefore);
+	
+	// Stacks still merge into the open one
+	Source->AddItem(Stone, 5);
+	const FInventoryItemHandle StoneHandle = GetHandleInSlot(Source, 1);
+	TestTrue(TEXT("Partial stack merges"), Source->MoveItemToInventory(Full, StoneHandle, 5));
+	TestEqual(TEXT("Merged into the open stack"), CountItems(Full, Stone), 18);
+	TestEqual(TEXT("Still two stacks"), Full->GetInventoryEntries().GetEntriesCount(), 2);
+	TestNull(TEXT("Source stack gone"), Source->FindEntryByHandle(StoneHandle));
+	
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryTransactionBroadcastTest, "ModularInventory.Transaction.OneBroadcastPerInventory",
+	MODULARINVENTORY_TEST_FLAGS)
+
+bool FInventoryTransactionBroadcastTest::RunTest(const FString& Parameters)
+{
+	FTestWorld TestWorld;
+	const UInventoryItemDefinition* Stone = MakeItemDefinition(TEXT("Stone"), 10);
+	const UInventoryItemDefinition* Sword = MakeItemDefinition(TEXT("Sword"), 1);
+	
+	UInventoryComponent* InventoryA = TestWorld.SpawnInventory(6);
+	UInventoryComponent* InventoryB = TestWorld.SpawnInventory(6);
+	InventoryA->AddItem(Stone, 8);
+	InventoryA->AddItem(Sword, 1);
+	InventoryB->AddItem(Stone, 4);
+	const FInventoryItemHandle StoneA = GetHandleInSlot(InventoryA, 0);
+	const FInventoryItemHandle SwordA = GetHandleInSlot(InventoryA, 1);
+	const FInventoryItemHandle StoneB = GetHandleInSlot(InventoryB, 0);
+	
+	FBroadcastCounter BroadcastsA(InventoryA);
+	FBroadcastCounter BroadcastsB(InventoryB);
+	FInventoryChangeSet LastChangeB;
+	InventoryB->OnInventoryChangedNative.AddLambda([&LastChangeB](const FInventoryChangeSet& ChangeSet) { LastChangeB = ChangeSet; });
+	
+	// Several changes on each side: quantities, a slot move, a transfer and new stacks
+	FInventoryTransaction Transaction;
+	TestTrue(TEXT("Remove"), Transaction.StageRemove(InventoryA, StoneA, 8));
+	TestTrue(TEXT("Add"), Transaction.StageAdd(InventoryB, Stone, 8));
+	TestTrue(TEXT("Move"), Transaction.StageMoveToSlot(InventoryB, StoneB, 5));
+	TestTrue(TEXT("Transfer"), Transaction.StageTransfer(InventoryA, SwordA, InventoryB, 0));
+	TestTrue(TEXT("Commit"), Transaction.Commit());
+	
+	TestEqual(TEXT("A broadcasts once"), BroadcastsA.Count, 1);
+	TestEqual(TEXT("B broadcasts once"), BroadcastsB.Count, 1);
+	TestEqual(TEXT("A is empty"), InventoryA->GetInventoryEntries().GetEntriesCount(), 0);
+	TestEqual(TEXT("B holds every stone"), CountItems(InventoryB, Stone), 12);
+	TestEqual(TEXT("Moved stack topped up"), GetQuantity(InventoryB, StoneB), 10);
+	TestEqual(TEXT("Moved stack in its new slot"), InventoryB->FindEntryByHandle(StoneB)->GetSlotIndex(), 5);
+	TestTrue(TEXT("Sword in slot 0"), InventoryB->FindEntryBySlot(0) && InventoryB->FindEntryBySlot(0)->GetItemDefinition() == Sword);
+	
+	// The change set is deduplicated: the moved and topped-up stack is one change
+	TestEqual(TEXT("B: new stone stack and sword added"), LastChangeB.Added.Num(), 2);
+	TestEqual(TEXT("B: one changed stack"), LastChangeB.Changed.Num(), 1);
+	
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryTransferToSelfTest, "ModularInventory.Transaction.TransferToSelf",
+	MODULARINVENTORY_TEST_FLAGS)
+
+/** A transfer into the same inventory is a move when it names a slot and rejected otherwise. */
+bool FInventoryTransferToSelfTest::RunTest(const FString& Parameters)
+{
+	FTestWorld TestWorld;
+	const UInventoryItemDefinition* Stone = MakeItemDefinition(TEXT("Stone"), 10);
+	
+	UInventoryComponent* Inventory = TestWorld.SpawnInventory(6);
+	Inventory->AddItem(Stone, 6);
+	const FInventoryItemHandle StoneHandle = GetHandleInSlot(Inventory, 0);
+	FBroadcastCounter Broadcasts(Inventory);
+	
+	TestFalse(TEXT("No slot: rejected"), Inventory->MoveItemToInventory(Inventory, StoneHandle, 2, INDEX_NONE));
+	TestEqual(TEXT("Stack untouched"), GetQuantity(Inventory, StoneHandle), 6);
+	TestEqual(TEXT("Nothing broadcast"), Broadcasts.Count, 0);
+	
+	TestTrue(TEXT("Partial quantity to a slot splits"), Inventory->MoveItemToInventory(Inventory, StoneHandle, 2, 3));
+	TestEqual(TEXT("Source keeps the rest"), GetQuantity(Inventory, StoneHandle), 4);
+	TestEqual(TEXT("Split stack in the slot"), Inventory->FindEntryBySlot(3) ? Inventory->FindEntryBySlot(3)->GetQuantity() : 0, 2);
+	
+	TestTrue(TEXT("Whole stack to a slot moves"), Inventory->MoveItemToInventory(Inventory, StoneHandle, 0, 5));
+	TestEqual(TEXT("Same stack in its new slot"), Inventory->FindEntryByHandle(StoneHandle) ? Inventory->FindEntryByHandle(StoneHandle)->GetSlotIndex() : INDEX_NONE, 5);
+	TestEqual(TEXT("Nothing created or lost"), CountItems(Inventory, Stone), 6);
+	
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -18,11 +18,10 @@ void UInventoryPanelWidget::NativeDestruct()
 {
 	if (SourceInventory)
 	{
-		SourceInventory->OnItemAdded.RemoveDynamic(this, &UInventoryPanelWidget::HandleItemAdded);
-		SourceInventory->OnItemRemoved.RemoveDynamic(this, &UInventoryPanelWidget::HandleItemRemoved);
-		SourceInventory->OnItemChanged.RemoveDynamic(this, &UInventoryPanelWidget::HandleItemChanged);
-		SourceInventory->OnInventoryRefreshed.RemoveDynamic(this, &UInventoryPanelWidget::HandleInventoryRefreshed);
+		SourceInventory->OnInventoryChangedNative.RemoveAll(this);
 		SourceInventory->OnMaxSlotsChanged.RemoveDynamic(this, &UInventoryPanelWidget::HandleMaxSlotsChanged);
+		SourceInventory->OnPendingSlotsChanged.RemoveDynamic(this, &UInventoryPanelWidget::HandlePendingSlotsChanged);
+		SourceInventory->OnPredictedSlotsChanged.RemoveAll(this);
 	}
 	
 	Super::NativeDestruct();
@@ -35,21 +34,20 @@ void UInventoryPanelWidget::InitializeWithInventory(UInventoryComponent* InInven
 	// Unbind from previous
 	if (SourceInventory)
 	{
-		SourceInventory->OnItemAdded.RemoveDynamic(this, &UInventoryPanelWidget::HandleItemAdded);
-		SourceInventory->OnItemRemoved.RemoveDynamic(this, &UInventoryPanelWidget::HandleItemRemoved);
-		SourceInventory->OnItemChanged.RemoveDynamic(this, &UInventoryPanelWidget::HandleItemChanged);
-		SourceInventory->OnInventoryRefreshed.RemoveDynamic(this, &UInventoryPanelWidget::HandleInventoryRefreshed);
+		SourceInventory->OnInventoryChangedNative.RemoveAll(this);
 		SourceInventory->OnMaxSlotsChanged.RemoveDynamic(this, &UInventoryPanelWidget::HandleMaxSlotsChanged);
+		SourceInventory->OnPendingSlotsChanged.RemoveDynamic(this, &UInventoryPanelWidget::HandlePendingSlotsChanged);
+		SourceInventory->OnPredictedSlotsChanged.RemoveAll(this);
 	}
 
 	SourceInventory = InInventory;
 
 	// Bind new
-	SourceInventory->OnItemAdded.AddDynamic(this, &UInventoryPanelWidget::HandleItemAdded);
-	SourceInventory->OnItemRemoved.AddDynamic(this, &UInventoryPanelWidget::HandleItemRemoved);
-	SourceInventory->OnItemChanged.AddDynamic(this, &UInventoryPanelWidget::HandleItemChanged);
-	SourceInventory->OnInventoryRefreshed.AddDynamic(this, &UInventoryPanelWidget::HandleInventoryRefreshed);
+	// One change set per scope, so a merge or batch add rebuilds once
+	SourceInventory->OnInventoryChangedNative.AddUObject(this, &UInventoryPanelWidget::HandleInventoryChanged);
 	SourceInventory->OnMaxSlotsChanged.AddDynamic(this, &UInventoryPanelWidget::HandleMaxSlotsChanged);
+	SourceInventory->OnPendingSlotsChanged.AddDynamic(this, &UInventoryPanelWidget::HandlePendingSlotsChanged);
+	SourceInventory->OnPredictedSlotsChanged.AddUObject(this, &UInventoryPanelWidget::HandlePredictedSlotsChanged);
 
 	RebuildFromInventory();
 }
@@ -61,70 +59,160 @@ void UInventoryPanelWidget::RebuildFromInventory()
 		return;
 	}
 
-	ItemsPanel->ClearChildren();
+	SetNumSlotWidgets(GetNumSlotsToShow());
 
-	const TArray<FInventoryEntry>& Items = SourceInventory->GetInventoryEntries().GetAllEntriesRef();
-	const int32 MaxSlots = SourceInventory->GetMaxSlots();
-	const int32 NumSlotsToShow = (MaxSlots > 0) ? MaxSlots : Items.Num();
+	DisplayedSlotByHandle.Reset();
+	for (int32 SlotIndex = 0; SlotIndex < SlotWidgets.Num(); ++SlotIndex)
+	{
+		RefreshSlot(SlotIndex);
+	}
 	
-	for (const auto Item : Items)
+	OnPanelRebuilt();
+}
+
+void UInventoryPanelWidget::RefreshSlot(int32 SlotIndex)
+{
+	if (!SourceInventory || !SlotWidgets.IsValidIndex(SlotIndex))
 	{
-		UE_LOG(LogTemp, Warning, TEXT("%s: %d"), *Item.GetDebugString(), Item.GetQuantity());
+		return;
 	}
 
-	for (int32 SlotIndex = 0; SlotIndex < NumSlotsToShow; ++SlotIndex)
+	UInventorySlotWidget* SlotWidget = SlotWidgets[SlotIndex];
+	if (!SlotWidget)
 	{
-		UInventorySlotWidget* SlotWidget = CreateWidget<UInventorySlotWidget>(this, SlotWidgetClass);
-		if (!SlotWidget)
+		return;
+	}
+
+	// Find item that belongs to this logical slot, predicted contents first
+	const FInventoryEntry* FoundItem = SourceInventory->FindDisplayedEntryBySlot(SlotIndex);
+	
+	if (FoundItem)
+	{
+		SlotWidget->SetupSlot(SourceInventory, SlotIndex, *FoundItem);
+		if (FoundItem->GetHandle().IsValid())
 		{
-			continue;
+			DisplayedSlotByHandle.Add(FoundItem->GetHandle(), SlotIndex);
 		}
+	}
+	else if (SourceInventory->IsSlotPending(SlotIndex))
+	{
+		SlotWidget->SetupPending(SourceInventory, SlotIndex);
+	}
+	else
+	{
+		SlotWidget->SetupEmpty(SourceInventory, SlotIndex);
+	}
+}
 
-		const int32 Row = SlotIndex / NumColumns;
-		const int32 Col = SlotIndex % NumColumns;
+int32 UInventoryPanelWidget::GetNumSlotsToShow() const
+{
+	const int32 MaxSlots = SourceInventory->GetMaxSlots();
+	return (MaxSlots > 0) ? MaxSlots : SourceInventory->GetInventoryEntries().GetEntriesCount();
+}
 
-		// Find item that belongs to this logical slot
-		const FInventoryEntry* FoundItem = Items.FindByPredicate(
-			[SlotIndex](const FInventoryEntry& Item)
-			{
-				return Item.GetSlotIndex() == SlotIndex;
-			});
-		
-		if (FoundItem)
+void UInventoryPanelWidget::SetNumSlotWidgets(int32 NumSlots)
+{
+	if (SlotWidgets.Num() == 0)
+	{
+		// First build: drop any designer preview children
+		ItemsPanel->ClearChildren();
+	}
+
+	while (SlotWidgets.Num() > NumSlots)
+	{
+		UInventorySlotWidget* SlotWidget = SlotWidgets.Pop();
+		if (SlotWidget)
 		{
-			SlotWidget->SetupSlot(SourceInventory, SlotIndex, *FoundItem);
+			SlotWidget->RemoveFromParent();
+			PooledSlotWidgets.Add(SlotWidget);
 		}
-		else
+	}
+
+	while (SlotWidgets.Num() < NumSlots)
+	{
+		const int32 SlotIndex = SlotWidgets.Num();
+		
+		UInventorySlotWidget* SlotWidget = PooledSlotWidgets.Num() > 0
+			? PooledSlotWidgets.Pop().Get()
+			: CreateWidget<UInventorySlotWidget>(this, SlotWidgetClass);
+
+		SlotWidgets.Add(SlotWidget);
+		if (!SlotWidget)
 		{
-			SlotWidget->SetupEmpty(SourceInventory, SlotIndex);
+			continue;
 		}
 
+		const int32 Row = SlotIndex / NumColumns;
+		const int32 Col = SlotIndex % NumColumns;
 		ItemsPanel->AddChildToUniformGrid(SlotWidget, Row, Col);
 	}
-	
-	OnPanelRebuilt();
 }
 
-void UInventoryPanelWidget::HandleItemAdded(const FInventoryEntry& Item)
+void UInventoryPanelWidget::HandleInventoryChanged(const FInventoryChangeSet& ChangeSet)
 {
-	RebuildFromInventory();
-}
+	if (!SourceInventory || !ItemsPanel || !SlotWidgetClass)
+	{
+		return;
+	}
 
-void UInventoryPanelWidget::HandleItemRemoved(const FInventoryEntry& Item)
-{
-	RebuildFromInventory();
+	// Slot count follows the entry count when MaxSlots is unbounded
+	if (SlotWidgets.Num() != GetNumSlotsToShow())
+	{
+		RebuildFromInventory();
+		return;
+	}
+
+	// Only touch the slots the changed entries left or landed in
+	TArray<int32, TInlineAllocator<8>> DirtySlots;
+	
+	for (const FInventoryEntry& Item : ChangeSet.Removed)
+	{
+		int32 OldSlot = Item.GetSlotIndex();
+		DisplayedSlotByHandle.RemoveAndCopyValue(Item.GetHandle(), OldSlot);
+		DirtySlots.AddUnique(OldSlot);
+	}
+
+	auto MarkMovedOrUpdated = [this, &DirtySlots](const FInventoryEntry& Item)
+	{
+		if (const int32* OldSlot = DisplayedSlotByHandle.Find(Item.GetHandle()))
+		{
+			DirtySlots.AddUnique(*OldSlot);
+		}
+		DirtySlots.AddUnique(Item.GetSlotIndex());
+	};
+	
+	for (const FInventoryEntry& Item : ChangeSet.Added)
+	{
+		MarkMovedOrUpdated(Item);
+	}
+	for (const FInventoryEntry& Item : ChangeSet.Changed)
+	{
+		MarkMovedOrUpdated(Item);
+	}
+
+	for (const int32 SlotIndex : DirtySlots)
+	{
+		RefreshSlot(SlotIndex);
+	}
 }
 
-void UInventoryPanelWidget::HandleItemChanged(const FInventoryEntry& Item)
+void UInventoryPanelWidget::HandleMaxSlotsChanged(int32 NewMaxSlots)
 {
+	// Widgets are pooled, so this only creates/removes the slots at the end
 	RebuildFromInventory();
 }
 
-void UInventoryPanelWidget::HandleInventoryRefreshed(const TArray<FInventoryEntry>& Items)
+void UInventoryPanelWidget::HandlePredictedSlotsChanged(const TArray<int32>& SlotIndices)
 {
-	RebuildFromInventory();
+	// Predictions and their rollback only ever touch the slots they name
+	for (const int32 SlotIndex : SlotIndices)
+	{
+		RefreshSlot(SlotIndex);
+	}
 }
 
-void UInventoryPanelWidget::HandleMaxSlotsChanged(int32 NewMaxSlots)
+void UInventoryPanelWidget::HandlePendingSlotsChanged()
 {
+	// Placeholders appear/disappear independently of entry changes
+	RebuildFromInventory();
 }
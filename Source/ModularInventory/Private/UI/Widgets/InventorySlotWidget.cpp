@@ -16,6 +16,7 @@ void UInventorySlotWidget::SetupSlot(UInventoryComponent* InInventory, int32 InS
 	SlotIndex = InSlotIndex;
 	ItemData = InItem;
 	bIsEmpty = false;
+	bIsPending = false;
 	
 	OnItemDataSet(); // BP: update icon, name, quantity, etc.
 }
@@ -26,10 +27,22 @@ void UInventorySlotWidget::SetupEmpty(UInventoryComponent* InInventory, int32 In
 	SlotIndex       = InSlotIndex;
 	ItemData        = FInventoryEntry(); // reset
 	bIsEmpty        = true;
+	bIsPending      = false;
 
 	OnEmptySlot();
 }
 
+void UInventorySlotWidget::SetupPending(UInventoryComponent* InInventory, int32 InSlotIndex)
+{
+	OwningInventory = InInventory;
+	SlotIndex       = InSlotIndex;
+	ItemData        = FInventoryEntry();
+	bIsEmpty        = true;
+	bIsPending      = true;
+
+	OnPendingSlot();
+}
+
 FReply UInventorySlotWidget::NativeOnMouseButtonDown(const FGeometry& InGeometry, const FPointerEvent& InMouseEvent)
 {
 	if (bIsEmpty)
@@ -68,7 +81,8 @@ void UInventorySlotWidget::NativeOnDragDetected(const FGeometry& InGeometry, con
 {
 	Super::NativeOnDragDetected(InGeometry, InMouseEvent, OutOperation);
 	
-	if (!OwningInventory || bIsEmpty)
+	// Predicted stacks the server has not created yet have no handle to send
+	if (!OwningInventory || bIsEmpty || !ItemData.GetHandle().IsValid())
 	{
 		bIsRightMouseDrag = false;
 		return;
@@ -77,7 +91,7 @@ void UInventorySlotWidget::NativeOnDragDetected(const FGeometry& InGeometry, con
 	UInventoryDragDropOperation* DragOp = NewObject<UInventoryDragDropOperation>();
 	DragOp->SourceInventory = OwningInventory;
 	DragOp->SourceSlotIndex = SlotIndex;
-	DragOp->ItemGuid        = ItemData.GetItemGuid();
+	DragOp->ItemHandle      = ItemData.GetHandle();
 
 	if (bIsRightMouseDrag && ItemData.GetQuantity() > 1)
 	{
@@ -95,15 +109,12 @@ void UInventorySlotWidget::NativeOnDragDetected(const FGeometry& InGeometry, con
 	
 	// 🔹 Get icon from the item’s UI fragment
 	UTexture2D* IconTex = nullptr;
-	if (ItemData.IsItemInstanceValid())
+	// Through the definition, instance-less stacks have no instance
+	if (const UItemFragment_UserInterface* UIFrag =
+		ItemData.FindFragmentByClass<UItemFragment_UserInterface>())
 	{
-		const UInventoryItemFragment* FragBase =
-		ItemData.GetItemInstance()->FindFragmentByClass(UItemFragment_UserInterface::StaticClass());
-		if (const UItemFragment_UserInterface* UIFrag = Cast<UItemFragment_UserInterface>(FragBase))
-		{
-			IconTex = UIFrag->GetIcon();
-			// DisplayName, Description, etc.
-		}
+		IconTex = UIFrag->GetIcon();
+		// DisplayName, Description, etc.
 	}
 	DragOp->Icon = IconTex;
 
@@ -138,49 +149,58 @@ bool UInventorySlotWidget::NativeOnDrop(const FGeometry& InGeometry, const FDrag
 	{
 		return false;
 	}
+	
+	// Everything goes through the player's own inventory, which batches the commands to the server
+	UInventoryComponent* CommandRouter = UInventoryComponent::FindCommandRouter(GetOwningPlayer());
+	if (!CommandRouter)
+	{
+		return false;
+	}
 
 	// ---- Split drag (right mouse) ----
 	if (DragOp->bIsSplitDrag && DragOp->SplitQuantity > 0)
 	{
-		if (!DragOp->SourceInventory || SlotIndex == INDEX_NONE || !DragOp->ItemGuid.IsValid())
+		if (!DragOp->SourceInventory || SlotIndex == INDEX_NONE || !DragOp->ItemHandle.IsValid())
 		{
 			return false;
 		}
 
-		// Same or different inventory both go through the same RPC:
+		// Same or different inventory both go through the same command:
 		// "split in SourceInventory, move half to OwningInventory at SlotIndex"
-		DragOp->SourceInventory->SplitAndMoveItem(
-			DragOp->ItemGuid,
+		CommandRouter->SubmitCommand(FInventoryCommand::MakeSplitAndMove(
+			DragOp->SourceInventory,
+			DragOp->ItemHandle,
 			DragOp->SplitQuantity,
 			OwningInventory,
 			SlotIndex
-		);
+		));
 
 		return true;
 	}
 
 	// ---- Normal drag (left mouse, full stack) ----
 
-	// Same inventory → reorder/move by Guid
+	// Same inventory → reorder/move by handle
 	if (DragOp->SourceInventory == OwningInventory)
 	{
-		if (SlotIndex != INDEX_NONE && DragOp->ItemGuid.IsValid())
+		if (SlotIndex != INDEX_NONE && DragOp->ItemHandle.IsValid())
 		{
-			OwningInventory->MoveItemByGuid(DragOp->ItemGuid, SlotIndex);
+			CommandRouter->SubmitCommand(FInventoryCommand::MakeMove(OwningInventory, DragOp->ItemHandle, SlotIndex));
 			return true;
 		}
 		return false;
 	}
 
 	// Different inventories → move full stack
-	if (DragOp->ItemGuid.IsValid() && DragOp->SourceInventory != OwningInventory)
+	if (DragOp->ItemHandle.IsValid() && DragOp->SourceInventory != OwningInventory)
 	{
-		DragOp->SourceInventory->MoveItemToInventory(
+		CommandRouter->SubmitCommand(FInventoryCommand::MakeTransfer(
+			DragOp->SourceInventory,
+			DragOp->ItemHandle,
 			OwningInventory,
-			DragOp->ItemGuid,
 			DragOp->Quantity,
 			SlotIndex
-		);
+		));
 		return true;
 	}
 
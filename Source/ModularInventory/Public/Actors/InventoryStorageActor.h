@@ -4,9 +4,9 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "Inventory/InventoryComponent.h"
 #include "InventoryStorageActor.generated.h"
 
-class UInventoryComponent;
 class UInventoryLootTable;
 
 UCLASS(BlueprintType)
@@ -19,8 +19,29 @@ public:
 
 protected:
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	
+	/**
+	 * Seconds without inventory changes before the actor goes dormant again (server).
+	 * Starts dormant (DORM_Initial), inventory mutations and viewer changes wake it. 0 keeps it awake after the first change.
+	 */
+	UPROPERTY(EditAnywhere, Category="Replication", meta=(ClampMin="0"))
+	float DormancyIdleDelay = 10.f;
 	
 private:
+	void HandleInventoryChanged(const FInventoryChangeSet& ChangeSet);
+	
+	UFUNCTION()
+	void HandleMaxSlotsChanged(int32 NewMaxSlots);
+	
+	void HandleViewersChanged(APlayerController* Viewer);
+	
+	/** Keeps the actor awake while its inventory is in use and (re)starts the idle timer. */
+	void WakeFromDormancy();
+	void GoDormant();
+	
+	FTimerHandle DormancyTimerHandle;
+	
 	UPROPERTY(EditAnywhere, Category="Loot")
 	UInventoryLootTable* LootTable;
 
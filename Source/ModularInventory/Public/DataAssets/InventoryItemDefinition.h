@@ -6,9 +6,38 @@
 #include "GameplayTagAssetInterface.h"
 #include "GameplayTagContainer.h"
 #include "Engine/DataAsset.h"
+#include "Inventory/InventoryCompiledTagQuery.h"
+#include "Inventory/Fragments/InventoryItemFragment.h"
 #include "InventoryItemDefinition.generated.h"
 
-class UInventoryItemFragment;
+class UInventoryItemInstance;
+
+/**
+ * Values the inventory hot paths need, baked from the fragments when the definition loads
+ * (or on first use for definitions created at runtime) so the stacking math reads one
+ * small block instead of chasing fragment UObjects.
+ */
+struct FInventoryItemHotData
+{
+	/** Class used for item instances (never null once baked). */
+	UClass* InstanceClass = nullptr;
+	/** 1 for non-stackable items. */
+	int32 MaxStackSize = 1;
+	uint8 bStackable : 1;
+	uint8 bHasIcon : 1;
+	uint8 bHasWorldMesh : 1;
+	/** False for instance-less definitions (stacks hold only the definition + quantity). */
+	uint8 bNeedsInstance : 1;
+
+	FInventoryItemHotData()
+		: bStackable(false)
+		, bHasIcon(false)
+		, bHasWorldMesh(false)
+		, bNeedsInstance(true)
+	{
+	}
+};
+
 /**
  * 
  */
@@ -32,7 +61,12 @@ public:
 	
 	// Runtime class for item instances
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Modular Inventory|Item Definition")
-	TSubclassOf<class UInventoryItemInstance> ItemInstanceClass;
+	TSubclassOf<UInventoryItemInstance> ItemInstanceClass;
+	
+	// Plain resources (wood, stone, ...): stacks store only this definition and a quantity and
+	// no UInventoryItemInstance is created, so there is no per-instance state or tags
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Modular Inventory|Item Definition")
+	bool bInstanceless = false;
 	
 	// Item fragments for behavior composition
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Modular Inventory|Item Definition")
@@ -40,17 +74,48 @@ public:
 	
 	const UInventoryItemFragment* FindFragmentByClass(TSubclassOf<UInventoryItemFragment> FragmentClass) const;
 	
+	/** Typed lookup: an array read through the fragment type index once the cache is built. */
 	template <typename FragmentType>
 	const FragmentType* FindFragmentByClass() const
 	{
-		return Cast<FragmentType>(FindFragmentByClass(FragmentType::StaticClass()));
+		static_assert(TIsDerivedFrom<FragmentType, UInventoryItemFragment>::Value, "FragmentType must derive from UInventoryItemFragment");
+		
+		if (bFragmentCacheBuilt)
+		{
+			const int32 TypeIndex = FInventoryFragmentTypeRegistry::GetTypeIndex<FragmentType>();
+			if (FragmentsByType.IsValidIndex(TypeIndex))
+			{
+				// Only fragments that passed IsA() are stored, no Cast needed
+				return static_cast<const FragmentType*>(FragmentsByType[TypeIndex]);
+			}
+		}
+		return static_cast<const FragmentType*>(FindFragmentByClass(FragmentType::StaticClass()));
 	}
 	
-	// Call this in editor / on load to refresh the cache
+	// Call this in editor / on load to refresh the cache (also rebakes the hot data)
 	void RebuildDynamicTags();
 
+	/** Hot-path values baked from the fragments. Call RebuildDynamicTags() after changing fragments at runtime. */
+	const FInventoryItemHotData& GetHotData() const { EnsureRuntimeData(); return HotData; }
+
+	// Rebuilds the class -> fragment lookup (done on load and on edit)
+	void RebuildFragmentCache();
+
+	//~UObject
+	virtual void PostLoad() override;
+	//~End UObject
+
 	// Get GameplayTags & DynamicTags
 	void GetCombinedTags(FGameplayTagContainer& OutTags) const;
+
+	/** GameplayTags & DynamicTags, merged once on load / rebuild. No copy, use this on hot paths. */
+	const FGameplayTagContainer& GetCachedCombinedTags() const { EnsureRuntimeData(); return CombinedTags; }
+
+	/** Bumped whenever the combined tags are rebuilt, so caches keyed by the definition can tell they went stale. */
+	uint32 GetTagsVersion() const { EnsureRuntimeData(); return TagsVersion; }
+
+	/** Combined tags as a FInventoryTagBitDomain mask for compiled tag queries. Rebuilt when the domain grows. */
+	const FInventoryTagMask& GetCombinedTagMask() const;
 	
 	//~IGameplayTagAssetInterface
 	virtual void GetOwnedGameplayTags(FGameplayTagContainer& TagContainer) const override;
@@ -59,4 +124,37 @@ public:
 #if WITH_EDITOR
 	virtual void PostEditChangeProperty(struct FPropertyChangedEvent& PropertyChangedEvent) override;
 #endif
+
+private:
+	// First fragment that IsA() each class in the fragments' hierarchies. Fragments are owned by the Fragments array.
+	TMap<const UClass*, const UInventoryItemFragment*> FragmentsByClass;
+	// Same data indexed by FInventoryFragmentTypeRegistry type index
+	TArray<const UInventoryItemFragment*> FragmentsByType;
+	bool bFragmentCacheBuilt = false;
+
+	FInventoryItemHotData HotData;
+
+	// Transient merge of GameplayTags and DynamicTags
+	FGameplayTagContainer CombinedTags;
+	uint32 TagsVersion = 0;
+
+	mutable FInventoryTagMask CombinedTagMask;
+	// Domain version CombinedTagMask was built against
+	mutable uint32 CombinedTagMaskVersion = MAX_uint32;
+
+	// Set once the caches above were built, by PostLoad or on first use
+	mutable bool bRuntimeDataBuilt = false;
+
+	void RebuildHotData();
+	void RebuildCombinedTags();
+
+	/** Definitions created with NewObject never see PostLoad: build the caches the first time they are read. */
+	void EnsureRuntimeData() const
+	{
+		if (!bRuntimeDataBuilt)
+		{
+			BuildRuntimeData();
+		}
+	}
+	void BuildRuntimeData() const;
 };
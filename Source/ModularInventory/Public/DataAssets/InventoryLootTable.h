@@ -5,6 +5,7 @@
 #include "CoreMinimal.h"
 #include "GameplayTagContainer.h"
 #include "Engine/DataAsset.h"
+#include "Inventory/InventoryCompiledTagQuery.h"
 #include "InventoryLootTable.generated.h"
 
 class UInventoryItemDefinition;
@@ -35,7 +36,10 @@ struct FLootItemEntry
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Loot", meta=(ClampMin="0.0"))
 	float Weight = 1.0f;
 
-	/** Optional tag query to restrict this entry (e.g. only in certain biomes or containers). */
+	/**
+	 * Optional tag query to restrict this entry (e.g. only in certain biomes or containers).
+	 * Matched against the target inventory's ContainerTags; ignored when the container has no tags.
+	 */
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Loot")
 	FGameplayTagQuery OptionalTagFilter;
 };
@@ -67,8 +71,19 @@ public:
 	UFUNCTION(BlueprintCallable, Category="Loot")
 	void GenerateLoot(class UInventoryComponent* TargetInventory, int32 RandomSeed = 0) const;
 
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(struct FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
 protected:
 	/** Pick a random entry using weights. Returns nullptr if nothing valid. */
 	const FLootItemEntry* PickRandomEntryWeighted(FRandomStream& Rng,
 	                                             UInventoryComponent* TargetInventory) const;
+
+private:
+	// OptionalTagFilter of each entry compiled to mask tests, parallel to Entries
+	mutable TArray<FInventoryCompiledTagQuery> CompiledFilters;
+	mutable bool bFiltersCompiled = false;
+
+	void EnsureFiltersCompiled() const;
 };
@@ -28,3 +28,26 @@ protected:
 	UPROPERTY(EditInstanceOnly, Category = "Fragment", meta = (DisplayName = "Fragment Tags"))
 	FGameplayTagContainer FragmentTags;
 };
+
+/**
+ * Hands out a dense, stable index per native fragment class.
+ * Item definitions use it to resolve FindFragmentByClass<T>() with a single array read.
+ */
+struct MODULARINVENTORY_API FInventoryFragmentTypeRegistry
+{
+	/** Returns the index of FragmentClass, registering it on first use. */
+	static int32 RegisterClass(const UClass* FragmentClass);
+
+	static int32 Num();
+	static const UClass* GetClass(int32 TypeIndex);
+
+	template <typename FragmentType>
+	static int32 GetTypeIndex()
+	{
+		static const int32 TypeIndex = RegisterClass(FragmentType::StaticClass());
+		return TypeIndex;
+	}
+
+private:
+	static TArray<const UClass*>& GetClasses();
+};
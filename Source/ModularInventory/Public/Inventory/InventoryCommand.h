@@ -0,0 +1,89 @@
+﻿// Copyright Peter Gyarmati (BitroseStudio)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "InventoryItemHandle.h"
+#include "InventoryCommand.generated.h"
+
+class UInventoryComponent;
+
+UENUM(BlueprintType)
+enum class EInventoryCommandType : uint8
+{
+	// Within one inventory, merges into a matching stack or swaps
+	Move			UMETA(DisplayName = "Move"),
+	// To another inventory, merges into a matching stack when possible
+	Transfer		UMETA(DisplayName = "Transfer"),
+	Split			UMETA(DisplayName = "Split"),
+	// Split off Quantity and move the new stack into TargetInventory/TargetSlotIndex
+	SplitAndMove	UMETA(DisplayName = "Split And Move"),
+	// UInventoryComponent::SortAndConsolidate by SortKey
+	Sort			UMETA(DisplayName = "Sort"),
+};
+
+/** Primary order of UInventoryComponent::SortAndConsolidate. Ties fall back to definition, then quantity. */
+UENUM(BlueprintType)
+enum class EInventorySortKey : uint8
+{
+	// Category tag of the definition (see UInventoryComponent::SortCategoryParentTag), untagged items last
+	Category		UMETA(DisplayName = "Category"),
+	DisplayName		UMETA(DisplayName = "Display Name"),
+	// Largest stacks first
+	Quantity		UMETA(DisplayName = "Quantity"),
+	
+	MAX				UMETA(Hidden)
+};
+
+/**
+ * One client inventory action, sent to the server in batches, see UInventoryComponent::SubmitCommand.
+ * A null source is filled in with the component the command is submitted to. Transfer and SplitAndMove
+ * need a target, the other types ignore it. The server rejects commands missing either.
+ */
+USTRUCT(BlueprintType)
+struct MODULARINVENTORY_API FInventoryCommand
+{
+	GENERATED_BODY()
+	
+	static FInventoryCommand MakeMove(UInventoryComponent* Inventory, FInventoryItemHandle ItemHandle, int32 TargetSlotIndex);
+	static FInventoryCommand MakeTransfer(UInventoryComponent* Source, FInventoryItemHandle ItemHandle, UInventoryComponent* Target, int32 Quantity, int32 TargetSlotIndex);
+	static FInventoryCommand MakeSplit(UInventoryComponent* Inventory, FInventoryItemHandle ItemHandle, int32 Quantity);
+	static FInventoryCommand MakeSort(UInventoryComponent* Inventory, EInventorySortKey SortKey);
+	static FInventoryCommand MakeSplitAndMove(UInventoryComponent* Source, FInventoryItemHandle ItemHandle, int32 Quantity, UInventoryComponent* Target, int32 TargetSlotIndex);
+	
+	/** Packed wire format: most commands fit in a handful of bytes plus the two references. */
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+	
+	// Assigned on submit, increases by one per command of the submitting component
+	UPROPERTY()
+	uint32 Sequence = 0;
+	
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Modular Inventory|Command")
+	EInventoryCommandType Type = EInventoryCommandType::Move;
+	
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Modular Inventory|Command")
+	TObjectPtr<UInventoryComponent> SourceInventory = nullptr;
+	
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Modular Inventory|Command")
+	FInventoryItemHandle ItemHandle;
+	
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Modular Inventory|Command")
+	TObjectPtr<UInventoryComponent> TargetInventory = nullptr;
+	
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Modular Inventory|Command")
+	int32 TargetSlotIndex = INDEX_NONE;
+	
+	// -1 = whole stack (Transfer)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Modular Inventory|Command")
+	int32 Quantity = -1;
+	
+	// Sort only, not sent for the other types
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Modular Inventory|Command")
+	EInventorySortKey SortKey = EInventorySortKey::Category;
+};
+
+template<>
+struct TStructOpsTypeTraits<FInventoryCommand> : public TStructOpsTypeTraitsBase2<FInventoryCommand>
+{
+	enum { WithNetSerializer = true };
+};
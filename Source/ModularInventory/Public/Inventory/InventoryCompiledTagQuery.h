@@ -0,0 +1,132 @@
+﻿// Copyright Peter Gyarmati (BitroseStudio)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameplayTagContainer.h"
+
+/**
+ * Fixed-size tag bitset. Bit positions come from FInventoryTagBitDomain.
+ */
+struct MODULARINVENTORY_API FInventoryTagMask
+{
+	static constexpr int32 NumWords = 2;
+	static constexpr int32 MaxBits = NumWords * 64;
+
+	uint64 Words[NumWords] = {};
+
+	void SetBit(int32 Bit)
+	{
+		Words[Bit >> 6] |= uint64(1) << (Bit & 63);
+	}
+
+	bool IsEmpty() const
+	{
+		uint64 Acc = 0;
+		for (int32 i = 0; i < NumWords; ++i)
+		{
+			Acc |= Words[i];
+		}
+		return Acc == 0;
+	}
+
+	/** True if any bit of Other is set here. */
+	bool HasAny(const FInventoryTagMask& Other) const
+	{
+		uint64 Acc = 0;
+		for (int32 i = 0; i < NumWords; ++i)
+		{
+			Acc |= Words[i] & Other.Words[i];
+		}
+		return Acc != 0;
+	}
+
+	/** True if every bit of Other is set here. */
+	bool HasAll(const FInventoryTagMask& Other) const
+	{
+		uint64 Missing = 0;
+		for (int32 i = 0; i < NumWords; ++i)
+		{
+			Missing |= Other.Words[i] & ~Words[i];
+		}
+		return Missing == 0;
+	}
+};
+
+/**
+ * Global tag -> bit assignment shared by compiled queries and item definitions.
+ * Bits are handed out on demand while compiling queries, so only tags that some filter
+ * actually references take up space. Game thread only.
+ */
+class MODULARINVENTORY_API FInventoryTagBitDomain
+{
+public:
+	static FInventoryTagBitDomain& Get();
+
+	/** Bit for Tag, assigned if needed. INDEX_NONE if the domain is full. */
+	int32 FindOrAddBit(const FGameplayTag& Tag);
+
+	int32 FindBit(const FGameplayTag& Tag) const;
+
+	/** Bumped whenever a bit is assigned. Masks built against an older version may be missing bits. */
+	uint32 GetVersion() const { return Version; }
+
+	/**
+	 * Mask of Tags including their parent tags, so a mask test against a query bit
+	 * gives the same answer as FGameplayTagContainer::HasTag.
+	 */
+	FInventoryTagMask MakeMask(const FGameplayTagContainer& Tags) const;
+
+private:
+	TMap<FGameplayTag, int32> TagToBit;
+	uint32 Version = 0;
+};
+
+/**
+ * FGameplayTagQuery compiled to mask tests.
+ * Handles a single ANY/ALL/NO tags expression, or one ANY/ALL/NO expression list of those.
+ * Anything else (nested lists, exact-match variants, invalid tags, a full bit domain)
+ * is left uncompiled and callers fall back to FGameplayTagQuery::Matches.
+ */
+class MODULARINVENTORY_API FInventoryCompiledTagQuery
+{
+public:
+	/** Returns true if Query could be compiled. */
+	bool Compile(const FGameplayTagQuery& Query);
+
+	void Reset();
+
+	bool IsCompiled() const { return bCompiled; }
+
+	/** Evaluate against a mask from FInventoryTagBitDomain::MakeMask. Only valid if IsCompiled(). */
+	bool Matches(const FInventoryTagMask& TagMask) const;
+
+private:
+	enum class ETermOp : uint8
+	{
+		AnyTags,
+		AllTags,
+		NoTags
+	};
+
+	enum class EListOp : uint8
+	{
+		Any,
+		All,
+		None
+	};
+
+	struct FTerm
+	{
+		FInventoryTagMask Mask;
+		ETermOp Op = ETermOp::AnyTags;
+	};
+
+	TArray<FTerm, TInlineAllocator<4>> Terms;
+	EListOp ListOp = EListOp::All;
+	bool bCompiled = false;
+
+	bool CompileTerm(const struct FGameplayTagQueryExpression& Expr, FTerm& OutTerm);
+
+	static bool EvaluateTerm(const FTerm& Term, const FInventoryTagMask& TagMask);
+};
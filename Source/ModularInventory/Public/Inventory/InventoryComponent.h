@@ -6,12 +6,15 @@
 #include "GameplayTagContainer.h"
 #include "InventoryItemInstance.h"
 #include "Components/ActorComponent.h"
+#include "InventoryCompiledTagQuery.h"
+#include "InventoryItemHandle.h"
+#include "InventoryCommand.h"
 #include "DataAssets/InventoryItemDefinition.h"
 #include "Net/Serialization/FastArraySerializer.h"
 #include "InventoryComponent.generated.h"
 
-class UItemFragment_Stackable;
 class UInventoryLootTable;
+class APlayerController;
 
 UENUM(BlueprintType)
 enum class EInventoryContainerType : uint8
@@ -22,6 +25,28 @@ enum class EInventoryContainerType : uint8
 	Storage			UMETA(DisplayName = "Storage"),
 };
 
+/**
+ * One item definition + quantity to add, see UInventoryComponent::AddItems.
+ */
+USTRUCT(BlueprintType)
+struct FItemAddRequest
+{
+	GENERATED_BODY()
+	
+	FItemAddRequest() {}
+	FItemAddRequest(const UInventoryItemDefinition* InItemDef, int32 InQuantity)
+		: ItemDef(InItemDef)
+		, Quantity(InQuantity)
+	{
+	}
+	
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Modular Inventory|Inventory")
+	TObjectPtr<const UInventoryItemDefinition> ItemDef = nullptr;
+	
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Modular Inventory|Inventory", meta=(ClampMin="1"))
+	int32 Quantity = 1;
+};
+
 /**
  * A single entry in an inventory
  */
@@ -42,36 +67,90 @@ struct FInventoryEntry : public FFastArraySerializerItem
 	bool IsItemInstanceValid() const { return IsValid(ItemInstance); }
 	
 	UInventoryItemInstance* GetItemInstance() const;
+	const UInventoryItemDefinition* GetItemDefinition() const { return ItemDef ? ItemDef.Get() : (ItemInstance ? ItemInstance->ItemDef.Get() : nullptr); }
 	int32 GetQuantity() const { return Quantity; }
+	FInventoryItemHandle GetHandle() const { return Handle; }
+	/** Globally unique id for persistence, invalid until UInventoryComponent::GetOrCreatePersistentGuid assigns it. Server only. */
 	FGuid GetItemGuid() const { return ItemGuid; }
 	int32 GetSlotIndex() const { return SlotIndex; }
 	
+	/**
+	 * Compact wire format for the legacy replication path, see FInventoryEntry::NetSerialize in the .cpp.
+	 * Iris replicates the replicated members directly instead (see Config/DefaultEngine.ini).
+	 * The server Guid never leaves the server.
+	 */
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+	
+	/** Fragment lookup through the definition, works for instance-less stacks too. */
+	template <typename FragmentType>
+	const FragmentType* FindFragmentByClass() const
+	{
+		const UInventoryItemDefinition* Definition = GetItemDefinition();
+		return Definition ? Definition->FindFragmentByClass<FragmentType>() : nullptr;
+	}
+	
 	/**
 	 * Debug
 	 */
 	FString GetDebugString() const
 	{
-		FString DefName = IsValid(ItemInstance) && ItemInstance->ItemDef
-			? ItemInstance->ItemDef->GetName()
+		const UInventoryItemDefinition* Definition = GetItemDefinition();
+		FString DefName = Definition
+			? Definition->GetName()
 			: TEXT("None");
-		return FString::Printf(TEXT("Item=%s Qty=%d Guid=%s"),
-			*DefName, Quantity, *ItemGuid.ToString());
+		return FString::Printf(TEXT("Item=%s Qty=%d Handle=%s"),
+			*DefName, Quantity, *Handle.ToString());
 	}
 	
 private:
 	friend struct FInventoryList;
+	friend struct FInventoryTransaction;
 	friend class UInventoryComponent;
 	
+	// Set for every entry; the only item data of instance-less stacks
+	UPROPERTY(BlueprintReadOnly, Category = "Modular Inventory|Inventory Entry", meta = (AllowPrivateAccess = true))
+	TObjectPtr<const UInventoryItemDefinition> ItemDef = nullptr;
+	// Null for instance-less definitions
 	UPROPERTY(BlueprintReadOnly, Category = "Modular Inventory|Inventory Entry", meta = (AllowPrivateAccess = true))
 	TObjectPtr<UInventoryItemInstance> ItemInstance = nullptr;
 	UPROPERTY(BlueprintReadOnly, Category = "Modular Inventory|Inventory Entry", meta = (AllowPrivateAccess = true))
 	int32 Quantity = 1;
 	UPROPERTY(BlueprintReadOnly, Category = "Modular Inventory|Inventory Entry", meta = (AllowPrivateAccess = true))
+	FInventoryItemHandle Handle;
+	// Persistence only, assigned on demand and never sent to clients
+	UPROPERTY(NotReplicated, BlueprintReadOnly, Category = "Modular Inventory|Inventory Entry", meta = (AllowPrivateAccess = true))
 	FGuid ItemGuid = FGuid();
 	UPROPERTY(BlueprintReadOnly, Category = "Modular Inventory|Inventory Entry", meta = (AllowPrivateAccess = true))
 	int32 SlotIndex = INDEX_NONE;
 };
 
+template<>
+struct TStructOpsTypeTraits<FInventoryEntry> : public TStructOpsTypeTraitsBase2<FInventoryEntry>
+{
+	enum { WithNetSerializer = true };
+};
+
+/**
+ * Entries touched during one FInventoryChangeScope, one record per item handle.
+ * Added/Changed hold the state at the end of the scope, Removed the last known state.
+ */
+USTRUCT(BlueprintType)
+struct FInventoryChangeSet
+{
+	GENERATED_BODY()
+	
+	UPROPERTY(BlueprintReadOnly, Category = "Modular Inventory|Inventory")
+	TArray<FInventoryEntry> Added;
+	
+	UPROPERTY(BlueprintReadOnly, Category = "Modular Inventory|Inventory")
+	TArray<FInventoryEntry> Removed;
+	
+	UPROPERTY(BlueprintReadOnly, Category = "Modular Inventory|Inventory")
+	TArray<FInventoryEntry> Changed;
+	
+	bool IsEmpty() const { return Added.Num() == 0 && Removed.Num() == 0 && Changed.Num() == 0; }
+};
+
 /**
  * List of inventory items
  */
@@ -95,24 +174,82 @@ struct FInventoryList : public FFastArraySerializer
 	int32 GetEntriesCount() const { return Entries.Num(); }
 	
 	FInventoryEntry& GetEntryByIndex(const int32 Index) { return Entries[Index]; };
-	
+
+	/** Array index of the entry the handle refers to, or INDEX_NONE if it is stale. Constant time. */
+	int32 IndexOfHandle(FInventoryItemHandle ItemHandle) const;
+
+	FInventoryEntry* FindEntryByHandle(FInventoryItemHandle ItemHandle); // Mutable
+	const FInventoryEntry* FindEntryByHandle(FInventoryItemHandle ItemHandle) const;
+
+	/** Array index of the entry occupying the given slot, or INDEX_NONE. Constant time. */
+	int32 IndexOfSlot(int32 SlotIndex) const;
+
+	FInventoryEntry* FindEntryBySlot(int32 SlotIndex); // Mutable
+	const FInventoryEntry* FindEntryBySlot(int32 SlotIndex) const;
+
+	/** First unoccupied slot below InMaxSlots, or INDEX_NONE if every slot is taken. */
+	int32 FindFirstFreeSlot(int32 InMaxSlots) const;
+
+	/** Moves the entry at Index into NewSlotIndex, keeping the slot table in sync. Does not mark dirty. */
+	void SetEntrySlot(int32 Index, int32 NewSlotIndex);
+
+	/** Indices of the stacks of ItemDef that still have room, or nullptr if there are none. */
+	const TArray<int32>* FindOpenStacks(const UInventoryItemDefinition* ItemDef) const;
+
+	/** Sets the quantity of the entry at Index, keeping the open-stack index in sync. Does not mark dirty. */
+	void SetEntryQuantity(int32 Index, int32 NewQuantity);
+
 	// FFastArraySerializer contract
 	// Called before removing elements and after the elements themselves are notified.  The indices are valid for this function call only! 
 	void PreReplicatedRemove(const TArrayView<int32> RemovedIndices, int32 FinalSize);
 	// Called after adding all new elements and after the elements themselves are notified.  The indices are valid for this function call only!
 	void PostReplicatedAdd(const TArrayView<int32> AddedIndices, int32 FinalSize);
+	// Called once after all the callbacks of a replication update
+	void PostReplicatedReceive(const FFastArraySerializer::FPostReplicatedReceiveParameters& Parameters);
 	// Called after updating all existing elements with new data and after the elements themselves are notified. The indices are valid for this function call only!
 	void PostReplicatedChange(const TArrayView<int32> ChangedIndices, int32 FinalSize);
 	// End FFastArraySerializer contract
 	
-	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+	/**
+	 * Hide the FFastArraySerializer versions: InventoryEntries is push based, so marking
+	 * an entry or the array dirty also has to mark the owning property dirty.
+	 */
+	void MarkItemDirty(FInventoryEntry& Item);
+	void MarkArrayDirty();
+	
+	/**
+	 * Paged lists (UInventoryComponent::bPagedReplication) hold back the entries a connection has
+	 * never received once they exceed its byte budget for this update. Entries it already has
+	 * always send their changes. Legacy replication only, Iris sends the list in one go.
+	 */
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms);
+	
+	/** Fast array write filter (shadows FFastArraySerializer's): skips the entries held back for this page. */
+	template<typename Type, typename SerializerType>
+	bool ShouldWriteFastArrayItem(const Type& Item, const bool bIsWritingOnClient)
 	{
-		return FFastArraySerializer::FastArrayDeltaSerialize<FInventoryEntry, FInventoryList>(Entries, DeltaParms, *this);
+		if (!FFastArraySerializer::ShouldWriteFastArrayItem<Type, SerializerType>(Item, bIsWritingOnClient))
+		{
+			return false;
+		}
+		return PageWithheldIDs.Num() == 0 || !PageWithheldIDs.Contains(Item.ReplicationID);
 	}
 	
-	void AddItem(UInventoryItemInstance* Instance, int32 Quantity);
-	void AddItem(UInventoryItemInstance* Instance, int32 Quantity, int32 PreferredSlotIndex);
-	bool RemoveItem(const FGuid& ItemGuid, int32 QuantityToRemove);
+	// Instance may be null for instance-less definitions. Returns the handle of the new stack.
+	FInventoryItemHandle AddItem(const UInventoryItemDefinition* ItemDef, UInventoryItemInstance* Instance, int32 Quantity);
+	FInventoryItemHandle AddItem(const UInventoryItemDefinition* ItemDef, UInventoryItemInstance* Instance, int32 Quantity, int32 PreferredSlotIndex);
+	bool RemoveItem(FInventoryItemHandle ItemHandle, int32 QuantityToRemove);
+	
+	/** Takes the whole entry out without releasing its instance, for moving it to another list (see InsertItem). */
+	bool ExtractItem(FInventoryItemHandle ItemHandle, FInventoryEntry& OutEntry);
+	/** Adds an entry taken out of a list by ExtractItem under a new handle of this one. Keeps instance, quantity and Guid. */
+	FInventoryItemHandle InsertItem(const FInventoryEntry& Entry, int32 SlotIndex);
+	
+	/** Client only: drops the local copy of the entries (broadcasting removals) without touching replication state. */
+	void ReleaseLocalCopy();
+	
+	/** Server: orders Entries by slot, so the fast array sends the lowest slots first. */
+	void SortEntriesBySlot();
 	
 private:
 	friend FInventoryEntry;
@@ -124,7 +261,60 @@ private:
 	UPROPERTY(NotReplicated)
 	TObjectPtr<UInventoryComponent> OwnerComponent;
 	
-	void AddItemToSlot(UInventoryItemInstance* Instance, int32 Quantity, int32 SlotIndex, UInventoryComponent* InOwnerComponent);
+	/**
+	 * Handle slot map: handle index -> entry index + current generation.
+	 * The server allocates from it; clients mirror it from the replicated handles.
+	 */
+	struct FHandleSlot
+	{
+		int32 EntryIndex = INDEX_NONE;
+		uint16 Generation = 0;
+	};
+	mutable TArray<FHandleSlot> HandleSlots;
+	// Server only: handle indices of removed stacks, reused with the next generation
+	TArray<int32> FreeHandleIndices;
+	// Number of entries the lookups were built for
+	mutable int32 NumIndexedEntries = 0;
+
+	/**
+	 * Lookup caches (not replicated).
+	 * Kept in sync incrementally on the server; replication reshuffles Entries on clients,
+	 * so the callbacks only flag them dirty and they get rebuilt on the next lookup.
+	 */
+	// Slot -> entry index, INDEX_NONE for empty slots
+	mutable TArray<int32> SlotToIndex;
+	// One bit per slot, set when occupied
+	mutable TBitArray<> OccupiedSlots;
+	// Definition -> indices of its stacks below the max stack size (stackable items only)
+	mutable TMap<const UInventoryItemDefinition*, TArray<int32>> OpenStacks;
+	mutable bool bLookupDirty = false;
+
+	void EnsureLookup() const;
+	void RebuildLookup() const;
+
+	void AssignHandle(FInventoryItemHandle ItemHandle, int32 Index) const;
+	FInventoryItemHandle AllocateHandle();
+	void ReleaseHandle(FInventoryItemHandle ItemHandle);
+
+	void AssignSlot(int32 SlotIndex, int32 Index) const;
+	void ReleaseSlot(int32 SlotIndex, int32 Index) const;
+
+	void RefreshOpenStack(int32 Index) const;
+	void RemoveOpenStack(const UInventoryItemDefinition* ItemDef, int32 Index) const;
+
+	FInventoryItemHandle AddItemToSlot(const UInventoryItemDefinition* ItemDef, UInventoryItemInstance* Instance, int32 Quantity, int32 SlotIndex, UInventoryComponent* InOwnerComponent);
+	
+	/** Indexes a new entry that already has its handle and slot, marks it dirty and reports the addition. */
+	FInventoryItemHandle AddNewEntry(const FInventoryEntry& NewEntry, UInventoryComponent* InOwnerComponent);
+
+	/** Removes the entry at Index (swapping the last entry into its place) and keeps the lookups in sync. */
+	void RemoveEntryAt(int32 Index);
+	
+	// Replication ids held back from the connection currently being written (paged lists)
+	TSet<int32> PageWithheldIDs;
+	
+	/** Fills PageWithheldIDs for the connection whose base state DeltaParms carries. */
+	void SelectPage(const FNetDeltaSerializeInfo& DeltaParms, int32 BudgetBits);
 };
 
 template<>
@@ -136,6 +326,12 @@ struct TStructOpsTypeTraits<FInventoryList> : public TStructOpsTypeTraitsBase2<F
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FInventoryItemChangeSignature, const FInventoryEntry&, Entry);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FInventoryRefreshedSignature, const TArray<FInventoryEntry>&, Entries);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FInventoryMaxSlotsChangedSignature, int32, NewMaxSlots);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FInventoryChangedSignature, const FInventoryChangeSet&, ChangeSet);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FInventoryPendingSlotsChangedSignature);
+DECLARE_MULTICAST_DELEGATE_OneParam(FInventoryChangedNativeSignature, const FInventoryChangeSet& /*ChangeSet*/);
+DECLARE_MULTICAST_DELEGATE_OneParam(FInventoryPredictedSlotsChangedSignature, const TArray<int32>& /*SlotIndices*/);
+DECLARE_MULTICAST_DELEGATE_OneParam(FInventoryViewersChangedSignature, APlayerController* /*Viewer*/);
+DECLARE_MULTICAST_DELEGATE_TwoParams(FInventoryCommandsAckedSignature, uint32 /*LastSequence*/, const TArray<uint32>& /*RejectedSequences*/);
 
 UCLASS(Blueprintable, ClassGroup=(ModularInventory), meta=(BlueprintSpawnableComponent))
 class MODULARINVENTORY_API UInventoryComponent : public UActorComponent
@@ -146,8 +342,27 @@ public:
 	UInventoryComponent();
 	
 	virtual void GetLifetimeReplicatedProps(TArray<class FLifetimeProperty>& OutLifetimeProps) const override;
+	virtual void InitializeComponent() override;
+	
+	/**
+	 * Flags InventoryEntries for replication (push model) and wakes a dormant owner.
+	 * Called by FInventoryList when it marks itself dirty. Deferred to the end of an open change scope.
+	 */
+	void MarkInventoryEntriesDirty();
+	
+	/** Makes a dormant owner replicate the pending changes (server only). */
+	void FlushOwnerNetDormancy() const;
+	
+	/** Per connection and net update budget for entries the connection has never received, 0 unless paged (server). */
+	int32 GetReplicationPageBudgetBits() const;
+	
+	/** Some connection still misses entries of a paged list: re-dirty the list next frame so they follow. */
+	void SchedulePendingPages();
 	
 	int32 FindFirstFreeSlotIndex() const;
+
+	/** Entry occupying the given slot, or nullptr if the slot is empty. */
+	const FInventoryEntry* FindEntryBySlot(int32 SlotIndex) const;
 	
 	FInventoryList& GetInventoryEntries() { return InventoryEntries; }
 	
@@ -163,13 +378,20 @@ public:
 	UFUNCTION(BlueprintPure, Category="Modular Inventory|Inventory")
 	int32 GetFreeSlotCount() const;
 	
-	FInventoryEntry* FindEntryByGuid(TArray<FInventoryEntry>& InEntries, const FGuid& ItemGuid); // Mutable
-	const FInventoryEntry* FindEntryByGuid(const TArray<FInventoryEntry>& InEntries, const FGuid& ItemGuid) const;
+	FInventoryEntry* FindEntryByHandle(FInventoryItemHandle ItemHandle); // Mutable
+	const FInventoryEntry* FindEntryByHandle(FInventoryItemHandle ItemHandle) const;
+
+	int32 FindIndexByHandle(FInventoryItemHandle ItemHandle) const;
 	
-	int32 FindIndexByGuid(TArray<FInventoryEntry>& InEntries, const FGuid& ItemGuid) const;
+	UFUNCTION(BlueprintPure, Category="Modular Inventory|Inventory", meta = (DisplayName = "Find Item by Handle"))
+	bool FindItemByHandle(FInventoryItemHandle ItemHandle, FInventoryEntry& OutItem) const;
 	
-	UFUNCTION(BlueprintPure, Category="Modular Inventory|Inventory", meta = (DisplayName = "Find Item by Guid"))
-	bool FindItemByGuid(const FGuid& ItemGuid, FInventoryEntry& OutItem) const;
+	/**
+	 * Globally unique id of a stack for save data (server only). Handles are per-inventory and
+	 * get reused, so persistence keys on this instead. Assigned on the first call.
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category="Modular Inventory|Inventory")
+	FGuid GetOrCreatePersistentGuid(FInventoryItemHandle ItemHandle);
 	
 	UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category = "Modular Inventory|Inventory")
 	void TryAddItem(const UInventoryItemDefinition* ItemDef);
@@ -177,50 +399,178 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Modular Inventory|Inventory", meta = (DisplayName = "Add Item", AllowedClasses = "InventoryItemDefinition"))
 	bool AddItem(const UInventoryItemDefinition* ItemDef, int32 Quantity);
 	
+	/**
+	 * Adds several items at once (server only). Requests for the same definition are merged,
+	 * stack fills and new slots are planned in one pass, and listeners get a single refresh.
+	 * @param bAllOrNothing		If anything would not fit (or is rejected), nothing is added.
+	 *							A new stack failing to get its item instance never adds anything either way.
+	 * @param OutRemainders		Optional, per request: the quantity that was not added.
+	 * @return true if every request was added in full.
+	 */
+	bool AddItems(TConstArrayView<FItemAddRequest> Requests, bool bAllOrNothing = false, TArray<int32>* OutRemainders = nullptr);
+	
+	UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category = "Modular Inventory|Inventory", meta = (DisplayName = "Add Items"))
+	bool K2_AddItems(const TArray<FItemAddRequest>& Requests, bool bAllOrNothing, TArray<int32>& OutRemainders);
+	
 	UFUNCTION(BlueprintCallable, Category="Modular Inventory|Inventory")
-	bool RemoveItem(const FGuid& ItemGuid, int32 QuantityToRemove);
+	bool RemoveItem(FInventoryItemHandle ItemHandle, int32 QuantityToRemove);
 	
 	UFUNCTION(BlueprintCallable, Category="Modular Inventory|Inventory")
 	bool SwapItems(int32 SlotIndexA, int32 SlotIndexB);
 	
+	/**
+	 * Merges the partial stacks of each definition, then lays every stack out from slot 0 in SortKey order.
+	 * One pass, one change set and one replication delta (server only, clients submit a Sort command).
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category="Modular Inventory|Inventory")
+	bool SortAndConsolidate(EInventorySortKey SortKey = EInventorySortKey::Category);
+	
 	UFUNCTION(BlueprintCallable)
-	bool SplitItemStack(const FGuid& ItemGuid, int32 SplitQuantity);
+	bool SplitItemStack(FInventoryItemHandle ItemHandle, int32 SplitQuantity);
 	
-	bool SplitItemStackForDrag(const FGuid& ItemGuid, int32 SplitQuantity, FGuid& OutNewStackGuid);
+	bool SplitItemStackForDrag(FInventoryItemHandle ItemHandle, int32 SplitQuantity, FInventoryItemHandle& OutNewStackHandle);
 	
-	// Temporary
-	void SplitAndMoveItem(const FGuid& SourceItemGuid, int32 SplitQuantity, UInventoryComponent* TargetInventory, int32 TargetSlotIndex);
+	// Temporary. True if the split-off stack ended up in the target.
+	bool SplitAndMoveItem(FInventoryItemHandle SourceItemHandle, int32 SplitQuantity, UInventoryComponent* TargetInventory, int32 TargetSlotIndex);
 	
 	UFUNCTION(BlueprintCallable, Category="Modular Inventory|Inventory")
 	bool MoveItemToInventory(
 		UInventoryComponent* TargetInventory, 
-		const FGuid& ItemGuid, 
+		FInventoryItemHandle ItemHandle, 
 		int32 Quantity = -1, 
 		int32 TargetSlotIndex = -1);
 	
 	UFUNCTION(BlueprintCallable, Category="Modular Inventory|Inventory")
-	bool MoveItemByGuid(const FGuid& ItemGuid, int32 TargetSlotIndex);
+	bool MoveItemByHandle(FInventoryItemHandle ItemHandle, int32 TargetSlotIndex);
+	
+	/**
+	 * Command pipeline. Clients queue commands on an inventory their connection owns (see FindCommandRouter),
+	 * they reach the server as one batch per frame and come back as one ack per batch.
+	 * The commands themselves may target any inventory the player can access. On the server they run right away.
+	 * @return The command's sequence number, 0 if it ran locally.
+	 */
+	uint32 SubmitCommand(FInventoryCommand Command);
+	
+	UFUNCTION(BlueprintCallable, Category="Modular Inventory|Commands", meta = (DisplayName = "Submit Command"))
+	void K2_SubmitCommand(const FInventoryCommand& Command);
+	
+	/** The inventory of the player's pawn or controller that can send commands for this player. */
+	UFUNCTION(BlueprintPure, Category="Modular Inventory|Commands")
+	static UInventoryComponent* FindCommandRouter(const APlayerController* PlayerController);
+	
+	/**
+	 * Server: whether the player may read/modify this inventory through commands. Inventories of
+	 * the player's own actors and containers the player is a viewer of, if AuthorizeAccess agrees.
+	 */
+	bool CanBeAccessedBy(const APlayerController* PlayerController) const;
+	
+	/** Game-specific access rules on top of CanBeAccessedBy, e.g. a range or line of sight check. Allows by default. */
+	UFUNCTION(BlueprintNativeEvent, Category="Modular Inventory|Commands")
+	bool AuthorizeAccess(const APlayerController* PlayerController) const;
+	virtual bool AuthorizeAccess_Implementation(const APlayerController* PlayerController) const;
 	
 	/** Checks if this container can accept the given definition (tag filter only, not capacity). */
 	UFUNCTION(BlueprintPure, Category="Modular Inventory|Inventory")
 	bool CanAcceptItemDefinition(const UInventoryItemDefinition* ItemDef) const;
+
+	/** Replace the tag query used to filter items. Clears the memoized accept/reject results. */
+	UFUNCTION(BlueprintCallable, Category="Modular Inventory|Inventory")
+	void SetAllowedItemTagQuery(const FGameplayTagQuery& NewQuery);
+
+	/** Tags describing this container. Loot table entry filters are evaluated against these. */
+	const FGameplayTagContainer& GetContainerTags() const { return ContainerTags; }
+	
+	/**
+	 * Players that opened the container. Only viewers may send commands to containers their
+	 * actors don't own (see CanBeAccessedBy). With viewer-based interest (storage/generic
+	 * containers with bReplicateToViewersOnly) only their connections receive the contents. Server only.
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category="Modular Inventory|Replication")
+	void AddViewer(APlayerController* Viewer);
+	
+	UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category="Modular Inventory|Replication")
+	void RemoveViewer(APlayerController* Viewer);
+	
+	UFUNCTION(BlueprintPure, Category="Modular Inventory|Replication")
+	bool IsViewer(const APlayerController* Viewer) const;
+	
+	/**
+	 * Client side of closing a viewer-replicated container: drops the replicated contents
+	 * and fires the removal events. The next AddViewer of that player resends everything.
+	 */
+	UFUNCTION(BlueprintCallable, Category="Modular Inventory|Replication")
+	void ReleaseViewedContents();
+	
+	/**
+	 * Paged replication, client side: true if the server reports the slot as occupied
+	 * but its entry has not arrived yet. UI shows a placeholder for these.
+	 */
+	UFUNCTION(BlueprintPure, Category="Modular Inventory|Replication")
+	bool IsSlotPending(int32 SlotIndex) const;
+	
+	/**
+	 * What the UI should show in the slot: the predicted contents while an unconfirmed command
+	 * touches it (see SubmitCommand), the replicated entry otherwise. Null if the slot shows empty.
+	 * Predicted stacks that do not exist on the server yet have an invalid handle.
+	 */
+	const FInventoryEntry* FindDisplayedEntryBySlot(int32 SlotIndex) const;
+	
+	/** True if the slot shows predicted contents the server has not confirmed yet. */
+	UFUNCTION(BlueprintPure, Category="Modular Inventory|Commands")
+	bool IsSlotPredicted(int32 SlotIndex) const;
+	
+	/** True if the contents only replicate to viewers. */
+	UFUNCTION(BlueprintPure, Category="Modular Inventory|Replication")
+	bool UsesViewerReplication() const;
 	
 	/** Fill this inventory using the specified loot table (server-only). */
 	UFUNCTION(BlueprintCallable, Category="Modular Inventory|Loot")
 	void GenerateLootFromTable(UInventoryLootTable* LootTable, int32 RandomSeed = 0);
 
-	// Called from FInventoryList
+	// Called from FInventoryList. Buffered while a change scope is open.
 	void PostInventoryItemAdded(const FInventoryEntry& Item);
 	void PostInventoryItemRemoved(const FInventoryEntry& Item);
 	void PostInventoryItemChanged(const FInventoryEntry& Item);
 	
-	virtual bool ReplicateSubobjects(UActorChannel* Channel, FOutBunch* Bunch, FReplicationFlags* RepFlags) override;
+	/** Opens a change scope, prefer FInventoryChangeScope. */
+	void BeginChangeScope();
+	/** Closes a change scope. The outermost one broadcasts the buffered changes. */
+	void EndChangeScope();
+	
+	bool IsInChangeScope() const { return ChangeScopeDepth > 0; }
+	
+	/** Takes a removed stack's instance off the subobject list and hands it to the pool once listeners saw the removal. */
+	void RecycleItemInstance(UInventoryItemInstance* Instance);
+	
+	/** Scope spanning one replication update on clients (opened by the first callback, closed in PostReplicatedReceive). */
+	void BeginReplicationChangeScope();
+	void EndReplicationChangeScope();
+	
 	virtual void ReadyForReplication() override;
+
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
 	
 	/**
 	 * Events
 	 **/
 	
+	/**
+	 * Native counterpart of OnInventoryChanged, fired first. One dispatch per change scope,
+	 * i.e. once per replication update on clients. Prefer this from C++.
+	 */
+	FInventoryChangedNativeSignature OnInventoryChangedNative;
+	
+	/** Client: predicted contents of these slots appeared or were replaced by the server's result. */
+	FInventoryPredictedSlotsChangedSignature OnPredictedSlotsChanged;
+	
+	/** Client: the server processed every command up to LastSequence, RejectedSequences failed. */
+	FInventoryCommandsAckedSignature OnCommandsAcknowledged;
+	
+	/** Server: a viewer was added or removed. Owners that manage their own dormancy wake up here. */
+	FInventoryViewersChangedSignature OnViewersChanged;
+	
 	/** Fired when a new item stack is created (or added by replication). */
 	UPROPERTY(BlueprintAssignable, Category = "Modular Inventory|Events")
 	FInventoryItemChangeSignature OnItemAdded;
@@ -230,14 +580,25 @@ public:
 	/** Fired when an existing stack changes (quantity, etc.). */
 	UPROPERTY(BlueprintAssignable, Category = "Modular Inventory|Events")
 	FInventoryItemChangeSignature OnItemChanged;
-	/** Fired when the whole inventory should be refreshed (optional use). */
+	/**
+	 * Fired once per outermost change scope with the deduplicated changes
+	 * (after the per-entry events above). Server and clients alike.
+	 */
+	UPROPERTY(BlueprintAssignable, Category="Modular Inventory|Events")
+	FInventoryChangedSignature OnInventoryChanged;
+	/** Fired when the whole inventory should be refreshed (optional use). Once per change scope. */
 	UPROPERTY(BlueprintAssignable, Category="Modular Inventory|Events")
 	FInventoryRefreshedSignature OnInventoryRefreshed;
 	/** Fired when MaxSlots changes (e.g., backpack equipped). */
 	UPROPERTY(BlueprintAssignable, Category="Modular Inventory|Events")
 	FInventoryMaxSlotsChangedSignature OnMaxSlotsChanged;
+	/** Paged replication: fired on clients when the set of occupied slots changes, see IsSlotPending. */
+	UPROPERTY(BlueprintAssignable, Category="Modular Inventory|Events")
+	FInventoryPendingSlotsChangedSignature OnPendingSlotsChanged;
 	
 protected:
+	friend struct FInventoryTransaction;
+	
 	UPROPERTY(Replicated)
 	FInventoryList InventoryEntries;
 	
@@ -256,15 +617,213 @@ protected:
 	 */
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Modular Inventory|Config")
 	FGameplayTagQuery AllowedItemTagQuery;
+
+	/**
+	 * Storage/generic containers only: replicate the contents to viewers (see AddViewer) instead of
+	 * every relevant connection. Player inventories and hotbars always use owner-only replication.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Modular Inventory|Config")
+	bool bReplicateToViewersOnly = true;
 	
-	UInventoryItemInstance* CreateItemInstance(const UInventoryItemDefinition* ItemDef);
+	/**
+	 * Opt-in for large containers: entries a connection has not received yet reach it at most
+	 * ReplicationPageBytes per net update, lowest slots first, instead of in one burst. Clients get
+	 * the occupied slots up front (see IsSlotPending). Legacy replication only.
+	 */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Modular Inventory|Config")
+	bool bPagedReplication = false;
+	
+	/**
+	 * Clients apply moves and split-moves within this inventory to a local overlay right away
+	 * instead of waiting for the round trip. Only for command routers (see FindCommandRouter),
+	 * ignored with bPagedReplication.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Modular Inventory|Config")
+	bool bPredictCommands = true;
 	
-	void FillExistingStacks(const UInventoryItemDefinition* ItemDef, const UItemFragment_Stackable* StackableFragment, int32& Quantity);
+	/**
+	 * Bytes of not yet received entries sent per connection and net update with bPagedReplication.
+	 * At least one entry always goes out. Changes to entries a connection already has are not paged.
+	 */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Modular Inventory|Config", meta=(EditCondition="bPagedReplication", ClampMin="1"))
+	int32 ReplicationPageBytes = 256;
+	
+	/**
+	 * Sorting by category groups items by their tag under this parent, e.g. Item.Category for
+	 * Item.Category.Weapon. Dynamic tags count. Several matches: the lexically smallest wins.
+	 * Unset: the lexically smallest of all the item's tags.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Modular Inventory|Config")
+	FGameplayTag SortCategoryParentTag;
+	
+	/** Tags describing this container (kind, biome, ...), e.g. Container.Chest. Used by loot table filters; leave empty to ignore them. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Modular Inventory|Config")
+	FGameplayTagContainer ContainerTags;
+
+	/** Memoized CanAcceptItemDefinition result and the definition tags version it was computed against. */
+	struct FAcceptedDefinition
+	{
+		uint32 TagsVersion = 0;
+		bool bAccepted = false;
+	};
+	
+	/** Cleared whenever the query changes, re-evaluated per definition when its tags are rebuilt. */
+	mutable TMap<FObjectKey, FAcceptedDefinition> AcceptedDefinitionCache;
+
+	/** AllowedItemTagQuery compiled to mask tests. Uncompiled queries use the generic evaluator. */
+	FInventoryCompiledTagQuery CompiledItemQuery;
 
-	void AddIntoNewSlots(const UInventoryItemDefinition* ItemDef, const UItemFragment_Stackable* StackableFragment, int32& Quantity);
+	/** Recompiles AllowedItemTagQuery and clears the memoized results. */
+	void CompileItemQuery();
+	
+	UInventoryItemInstance* CreateItemInstance(const UInventoryItemDefinition* ItemDef);
+	
+	/** Creates the instance for a new stack of ItemDef, leaves OutInstance null for instance-less definitions. False on failure. */
+	bool CreateItemInstanceIfNeeded(const UInventoryItemDefinition* ItemDef, UInventoryItemInstance*& OutInstance);
+	
+	enum class EPendingChange : uint8
+	{
+		None,		// Added and removed in the same scope
+		Added,
+		Removed,
+		Changed
+	};
+	
+	struct FPendingChange
+	{
+		EPendingChange Kind = EPendingChange::None;
+		FInventoryItemHandle Handle;
+		// Last known state, only captured for removals (the rest reads the live entry when broadcasting)
+		FInventoryEntry RemovedEntry;
+	};
+	
+	int32 ChangeScopeDepth = 0;
+	bool bReplicationScopeOpen = false;
+	// Entries were marked dirty inside the open scope
+	bool bEntriesDirtyInScope = false;
+	
+	// Changes buffered by the open scope, in first-touched order
+	TArray<FPendingChange> PendingChanges;
+	TMap<FInventoryItemHandle, int32> PendingChangeIndices;
+	
+	void RecordChange(const FInventoryEntry& Entry, EPendingChange Kind);
+	void BroadcastPendingChanges();
+	
+	// Instances of stacks removed in the open scope, pooled after the change set went out
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<UInventoryItemInstance>> PendingRecycledInstances;
+	
+	void FlushRecycledInstances();
+	
+	// Connections currently receiving the contents (server only)
+	UPROPERTY(Transient)
+	TArray<TWeakObjectPtr<APlayerController>> Viewers;
+	
+	// Removed viewers. Their connections keep the old fast array state, so rejoining needs a resend
+	UPROPERTY(Transient)
+	TArray<TWeakObjectPtr<APlayerController>> FormerViewers;
+	
+	/** Net condition group of this component's viewers. */
+	FName GetViewerNetGroup() const;
+	
+	static constexpr int32 MaxCommandsPerBatch = 64;
+	
+	// Client side of the command pipeline
+	uint32 LastSubmittedCommandSequence = 0;
+	TArray<FInventoryCommand> QueuedCommands;
+	bool bCommandFlushScheduled = false;
+	
+	void FlushQueuedCommands();
+	
+	UFUNCTION(Server, Reliable)
+	void ServerExecuteCommands(const TArray<FInventoryCommand>& Commands);
+	
+	UFUNCTION(Client, Reliable)
+	void ClientAckCommands(uint32 LastSequence, const TArray<uint32>& RejectedSequences);
+	
+	/** Runs one command on the server after the access checks. */
+	bool ExecuteCommand(const FInventoryCommand& Command, const APlayerController* Issuer);
+	
+	/** Controller at the end of the owner chain, if any. */
+	APlayerController* GetOwningPlayerController() const;
+	
+	/**
+	 * Highest command sequence the server executed. Replicates together with the entries it
+	 * changed, so its OnRep is the point where the results of those commands are in.
+	 */
+	UPROPERTY(ReplicatedUsing=OnRep_LastProcessedCommandSequence)
+	uint32 LastProcessedCommandSequence = 0;
+	
+	UFUNCTION()
+	void OnRep_LastProcessedCommandSequence();
+	
+	/** Client-side result of one unconfirmed command. */
+	struct FInventoryPrediction
+	{
+		uint32 Sequence = 0;
+		// Predicted contents of every slot the command touches. Quantity 0 = empty,
+		// the handle is kept if the stack was merged away.
+		TMap<int32, FInventoryEntry> Slots;
+	};
+	
+	// Oldest first, later predictions win per slot
+	TArray<FInventoryPrediction> Predictions;
+	
+	/** Applies a submitted command to the overlay if it is predictable. True if a prediction was added. */
+	bool PredictCommand(const FInventoryCommand& Command);
+	
+	/** Predicted state of the stack, false if it does not exist (anymore). */
+	bool FindDisplayedEntryByHandle(FInventoryItemHandle ItemHandle, FInventoryEntry& OutEntry) const;
+	
+	/** Drops the predictions the server has answered and refreshes their slots. */
+	void ReconcilePredictions(uint32 ProcessedSequence);
+	
+	// Paged replication: one bit per slot below MaxSlots, set if occupied
+	UPROPERTY(ReplicatedUsing=OnRep_ReplicatedSlotMask)
+	TArray<uint8> ReplicatedSlotMask;
+	
+	/** Server: rebuilds ReplicatedSlotMask, marking it dirty only if it changed. */
+	void UpdateReplicatedSlotMask();
+	
+	// A next-frame re-dirty for held back pages is queued
+	bool bPendingPagesScheduled = false;
+	
+	void SendPendingPages();
+	
+	UFUNCTION()
+	void OnRep_ReplicatedSlotMask();
 	
 	UFUNCTION()
 	void OnRep_MaxSlots();
 	
 	void HandleMaxSlotsChanged();
 };
+
+/**
+ * Buffers the change notifications of an inventory until the outermost scope closes,
+ * then broadcasts them once as a deduplicated FInventoryChangeSet.
+ */
+struct FInventoryChangeScope
+{
+	explicit FInventoryChangeScope(UInventoryComponent* InInventory)
+		: Inventory(InInventory)
+	{
+		if (Inventory)
+		{
+			Inventory->BeginChangeScope();
+		}
+	}
+	
+	~FInventoryChangeScope()
+	{
+		if (Inventory)
+		{
+			Inventory->EndChangeScope();
+		}
+	}
+	
+	UE_NONCOPYABLE(FInventoryChangeScope);
+	
+private:
+	UInventoryComponent* Inventory;
+};
@@ -0,0 +1,71 @@
+﻿// Copyright Peter Gyarmati (BitroseStudio)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "InventoryItemHandle.generated.h"
+
+/**
+ * Reference to an item stack within one inventory: slot map index + generation packed into 32 bits.
+ * Handles are only meaningful for the inventory that issued them. Removing a stack bumps its
+ * generation on reuse, so a stale handle never resolves to a newer stack in the same slot.
+ * Persistence should use UInventoryComponent::GetOrCreatePersistentGuid instead.
+ */
+USTRUCT(BlueprintType)
+struct MODULARINVENTORY_API FInventoryItemHandle
+{
+	GENERATED_BODY()
+	
+	static constexpr int32 IndexBits = 16;
+	static constexpr uint32 IndexMask = (1u << IndexBits) - 1;
+	// Highest slot map index a handle can address
+	static constexpr int32 MaxIndex = IndexMask;
+	
+	FInventoryItemHandle() {}
+	
+	/** Generation 0 is reserved, so every handle made from a live slot is valid. */
+	static FInventoryItemHandle Make(int32 Index, uint16 Generation)
+	{
+		check(Index >= 0 && Index <= MaxIndex && Generation != 0);
+		FInventoryItemHandle Handle;
+		Handle.Value = (uint32(Generation) << IndexBits) | uint32(Index);
+		return Handle;
+	}
+	
+	bool IsValid() const { return Value != 0; }
+	void Invalidate() { Value = 0; }
+	
+	int32 GetIndex() const { return int32(Value & IndexMask); }
+	uint16 GetGeneration() const { return uint16(Value >> IndexBits); }
+	
+	bool operator==(const FInventoryItemHandle& Other) const { return Value == Other.Value; }
+	bool operator!=(const FInventoryItemHandle& Other) const { return Value != Other.Value; }
+	
+	friend uint32 GetTypeHash(const FInventoryItemHandle& Handle) { return Handle.Value; }
+	
+	/** Wire format: index and generation as separate packed ints, so neither pays for the other's bits. */
+	void SerializePacked(FArchive& Ar)
+	{
+		uint32 PackedIndex = static_cast<uint32>(GetIndex());
+		uint32 PackedGeneration = GetGeneration();
+		Ar.SerializeIntPacked(PackedIndex);
+		Ar.SerializeIntPacked(PackedGeneration);
+		
+		if (Ar.IsLoading())
+		{
+			const bool bValid = PackedGeneration != 0 && PackedGeneration <= MAX_uint16 && PackedIndex <= static_cast<uint32>(MaxIndex);
+			*this = bValid ? Make(static_cast<int32>(PackedIndex), static_cast<uint16>(PackedGeneration)) : FInventoryItemHandle();
+		}
+	}
+	
+	FString ToString() const
+	{
+		return IsValid()
+			? FString::Printf(TEXT("%d:%d"), GetIndex(), GetGeneration())
+			: TEXT("Invalid");
+	}
+	
+private:
+	UPROPERTY()
+	uint32 Value = 0;
+};
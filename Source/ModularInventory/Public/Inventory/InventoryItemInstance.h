@@ -4,11 +4,10 @@
 
 #include "CoreMinimal.h"
 #include "GameplayTagContainer.h"
+#include "DataAssets/InventoryItemDefinition.h"
 #include "UObject/Object.h"
 #include "InventoryItemInstance.generated.h"
 
-class UInventoryItemFragment;
-class UInventoryItemDefinition;
 /**
  * 
  */
@@ -27,7 +26,10 @@ public:
 	UPROPERTY(Replicated, BlueprintReadOnly, Category = "Modular Inventory|Item")
 	TObjectPtr<const UInventoryItemDefinition> ItemDef = nullptr;
 
-	/** Optional per-instance tags: durability state, flags, etc. */
+	/**
+	 * Optional per-instance tags: durability state, flags, etc.
+	 * Push replicated: prefer Add/RemoveInstanceTag, or call MarkInstanceTagsDirty after editing directly.
+	 */
 	UPROPERTY(Replicated, BlueprintReadOnly, Category = "Modular Inventory|Item")
 	FGameplayTagContainer InstanceTags;
 
@@ -38,6 +40,24 @@ public:
 	/** Initialize this instance from a definition + owning actor. */
 	virtual void Initialize(const UInventoryItemDefinition* InItemDef, AActor* InOwner);
 
+	/** Clears per-item state before the instance goes back to the pool. Override to reset custom state. */
+	virtual void ResetForPool();
+	
+	/**
+	 * Takes over the per-item state of another instance of the same definition, used when a stack moves
+	 * to another actor (instances can't change channels). Override to copy custom state.
+	 */
+	virtual void CopyStateFrom(const UInventoryItemInstance* Other);
+
+	UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category="Modular Inventory|Item")
+	void AddInstanceTag(FGameplayTag Tag);
+
+	UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category="Modular Inventory|Item")
+	void RemoveInstanceTag(FGameplayTag Tag);
+
+	/** Flags InstanceTags for replication (push model). */
+	void MarkInstanceTagsDirty();
+
 	UFUNCTION(BlueprintPure, Category="Modular Inventory|Item")
 	AActor* GetOwningActor() const { return OwningActor; }
 
@@ -53,7 +73,7 @@ public:
 	template<typename ResultClass>
 	const ResultClass* FindFragmentByClass() const
 	{
-		return Cast<ResultClass>(FindFragmentByClass(ResultClass::StaticClass()));
+		return ItemDef ? ItemDef->FindFragmentByClass<ResultClass>() : nullptr;
 	}
 
 
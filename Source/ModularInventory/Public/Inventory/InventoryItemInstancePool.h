@@ -0,0 +1,87 @@
+﻿// Copyright Peter Gyarmati (BitroseStudio)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "InventoryItemInstancePool.generated.h"
+
+class UInventoryItemInstance;
+
+/** Pool bucket key: instances are only reused for the same class and the actor that outers them. */
+USTRUCT()
+struct FInventoryItemInstancePoolKey
+{
+	GENERATED_BODY()
+	
+	UPROPERTY(Transient)
+	TObjectPtr<UClass> InstanceClass = nullptr;
+	
+	// Weak so the key doesn't keep the actor alive; its hash survives the actor
+	TWeakObjectPtr<const AActor> Owner;
+	
+	bool operator==(const FInventoryItemInstancePoolKey& Other) const
+	{
+		return InstanceClass == Other.InstanceClass && Owner == Other.Owner;
+	}
+	
+	friend uint32 GetTypeHash(const FInventoryItemInstancePoolKey& Key)
+	{
+		return HashCombine(GetTypeHash(Key.InstanceClass), GetTypeHash(Key.Owner));
+	}
+};
+
+USTRUCT()
+struct FInventoryItemInstancePoolBucket
+{
+	GENERATED_BODY()
+	
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<UInventoryItemInstance>> Instances;
+};
+
+/**
+ * Per-world pool of item instances, keyed by instance class and owning actor (server only).
+ * Instances are only handed back to the actor that outers them: a replicated subobject
+ * can't move to another actor's channel, but it can be re-registered on its own one.
+ * Buckets of destroyed actors are dropped on a timer.
+ */
+UCLASS()
+class MODULARINVENTORY_API UInventoryItemInstancePool : public UWorldSubsystem
+{
+	GENERATED_BODY()
+	
+public:
+	static UInventoryItemInstancePool* Get(const UWorld* World);
+	
+	/** A pooled instance of exactly InstanceClass outered to Owner, or nullptr. Caller must Initialize it. */
+	UInventoryItemInstance* Acquire(TSubclassOf<UInventoryItemInstance> InstanceClass, const AActor* Owner);
+	
+	/** Resets the instance and keeps it for reuse. It must already be out of every inventory and subobject list. */
+	void Release(UInventoryItemInstance* Instance);
+	
+	int32 GetNumPooled() const;
+	
+	/** Drops the buckets of actors that are gone (their instances would keep them alive otherwise). */
+	void PruneDeadOwners();
+	
+	//~UWorldSubsystem
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+	//~End UWorldSubsystem
+	
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	
+private:
+	/** Cap per class and owner, the oldest entries are dropped to GC past this. */
+	static constexpr int32 MaxPooledPerBucket = 32;
+	
+	/** Seconds between two PruneDeadOwners passes. */
+	static constexpr float PruneInterval = 10.f;
+	
+	UPROPERTY(Transient)
+	TMap<FInventoryItemInstancePoolKey, FInventoryItemInstancePoolBucket> Buckets;
+	
+	FTimerHandle PruneTimerHandle;
+};
@@ -0,0 +1,107 @@
+﻿// Copyright Peter Gyarmati (BitroseStudio)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "InventoryItemHandle.h"
+
+class UInventoryComponent;
+class UInventoryItemDefinition;
+class UInventoryItemInstance;
+
+/**
+ * Stages changes against one or more inventories and applies them all or not at all (server only).
+ * Every Stage call is validated (capacity, tag filters, stack sizes) against the inventories as they
+ * will look after the earlier staged changes, without touching them. A failed stage poisons the
+ * transaction, Commit then does nothing. Commit applies everything inside one change scope per
+ * inventory, so each inventory marks itself dirty and broadcasts once.
+ */
+struct MODULARINVENTORY_API FInventoryTransaction
+{
+	FInventoryTransaction() = default;
+	
+	UE_NONCOPYABLE(FInventoryTransaction);
+	
+	/** Takes Quantity off the stack, removing it when it reaches 0. */
+	bool StageRemove(UInventoryComponent* Inventory, FInventoryItemHandle ItemHandle, int32 Quantity);
+	
+	/**
+	 * Puts all of Quantity into the slot: a new stack if it is free, a top-up if it holds a matching stack.
+	 * INDEX_NONE always starts a new stack in the first free slot.
+	 */
+	bool StageAddToSlot(UInventoryComponent* Inventory, const UInventoryItemDefinition* ItemDef, int32 Quantity, int32 SlotIndex);
+	
+	/** Puts all of Quantity anywhere, open stacks first, then free slots (like UInventoryComponent::AddItems). */
+	bool StageAdd(UInventoryComponent* Inventory, const UInventoryItemDefinition* ItemDef, int32 Quantity);
+	
+	/** Moves an existing stack to a free slot of its inventory, INDEX_NONE for the first free one. */
+	bool StageMoveToSlot(UInventoryComponent* Inventory, FInventoryItemHandle ItemHandle, int32 SlotIndex);
+	
+	/** Moves a whole stack, entry record and instance, into a free slot of another inventory. */
+	bool StageTransfer(UInventoryComponent* Source, FInventoryItemHandle ItemHandle, UInventoryComponent* Target, int32 TargetSlotIndex);
+	
+	/** Exchanges two whole stacks, each taking the other's slot. Both filters apply, the inventories may be the same. */
+	bool StageSwap(UInventoryComponent* InventoryA, FInventoryItemHandle HandleA, UInventoryComponent* InventoryB, FInventoryItemHandle HandleB);
+	
+	/** False once a stage failed. */
+	bool IsValid() const { return !bFailed; }
+	
+	/** Applies every staged change. False (and nothing touched) if a stage failed or a new stack can't get its instance. */
+	bool Commit();
+	
+	/** After a successful commit: handles of the new and transferred stacks, in staging order. */
+	const TArray<FInventoryItemHandle>& GetCreatedHandles() const { return CreatedHandles; }
+	
+private:
+	struct FNewStack
+	{
+		const UInventoryItemDefinition* ItemDef = nullptr;
+		int32 Quantity = 0;
+		int32 SlotIndex = INDEX_NONE;
+		// Creation order across all inventories, for GetCreatedHandles
+		int32 Order = INDEX_NONE;
+		UInventoryItemInstance* Instance = nullptr;
+		// Set for stacks moved in from another inventory, the quantity comes with the record
+		UInventoryComponent* TransferSource = nullptr;
+		FInventoryItemHandle TransferHandle;
+	};
+	
+	/** What one inventory will look like after the staged changes. */
+	struct FInventoryState
+	{
+		UInventoryComponent* Inventory = nullptr;
+		// Final quantity / slot of the touched existing stacks
+		TMap<FInventoryItemHandle, int32> Quantities;
+		TMap<FInventoryItemHandle, int32> Slots;
+		TArray<FNewStack> NewStacks;
+		int32 NumEntries = 0;
+	};
+	
+	TArray<FInventoryState, TInlineAllocator<2>> States;
+	TArray<FInventoryItemHandle> CreatedHandles;
+	int32 NumNewStacks = 0;
+	bool bFailed = false;
+	bool bCommitted = false;
+	
+	/** Projection of the inventory, null (and the transaction failed) if it can't be changed from here. */
+	FInventoryState* FindOrAddState(UInventoryComponent* Inventory);
+	
+	bool Fail(const TCHAR* Reason);
+	
+	/** Staged quantity of an existing stack, 0 if it is (or will be) gone. */
+	static int32 GetProjectedQuantity(const FInventoryState& State, FInventoryItemHandle ItemHandle);
+	
+	static bool IsSlotInRange(const FInventoryState& State, int32 SlotIndex);
+	static bool HasRoomForNewStack(const FInventoryState& State);
+	
+	/** Occupant of the slot after the staged changes: an existing stack (OutHandle) or a new one (OutNewStackIndex). False if free. */
+	static bool FindProjectedOccupant(const FInventoryState& State, int32 SlotIndex, FInventoryItemHandle& OutHandle, int32& OutNewStackIndex);
+	
+	static int32 FindProjectedFreeSlot(const FInventoryState& State);
+	
+	int32 AddNewStack(FInventoryState& State, const UInventoryItemDefinition* ItemDef, int32 Quantity, int32 SlotIndex);
+	
+	/** Stages a whole, so far untouched stack leaving its inventory. Its definition, null on failure. */
+	const UInventoryItemDefinition* StageTransferOut(FInventoryState& State, FInventoryItemHandle ItemHandle, int32& OutSlotIndex);
+	bool StageTransferIn(FInventoryState& State, UInventoryComponent* Source, FInventoryItemHandle ItemHandle, const UInventoryItemDefinition* ItemDef, int32 SlotIndex);
+};
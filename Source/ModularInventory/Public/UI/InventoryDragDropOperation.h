@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "Blueprint/DragDropOperation.h"
+#include "Inventory/InventoryItemHandle.h"
 #include "InventoryDragDropOperation.generated.h"
 
 class UInventoryComponent;
@@ -24,9 +25,9 @@ public:
 	UPROPERTY(BlueprintReadOnly, Category="Modular Inventory|DragDrop")
 	int32 SourceSlotIndex = INDEX_NONE;
 
-	/** Guid of the item stack being dragged. */
+	/** Handle of the item stack being dragged (in SourceInventory). */
 	UPROPERTY(BlueprintReadOnly, Category="Modular Inventory|DragDrop")
-	FGuid ItemGuid;
+	FInventoryItemHandle ItemHandle;
 
 	/** Quantity being dragged (for now: whole stack). */
 	UPROPERTY(BlueprintReadOnly, Category="Modular Inventory|DragDrop")
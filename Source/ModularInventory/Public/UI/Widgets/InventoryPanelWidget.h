@@ -39,26 +39,25 @@ public:
 	UFUNCTION(BlueprintCallable, Category="Modular Inventory|UI")
 	void InitializeWithInventory(UInventoryComponent* InInventory);
 
-	/** Rebuild all slots from current inventory state. */
+	/** Refresh all slots from current inventory state. Slot widgets are reused, not recreated. */
 	UFUNCTION(BlueprintCallable, Category="Modular Inventory|UI")
 	void RebuildFromInventory();
 
+	/** Refresh a single slot from the inventory. */
+	UFUNCTION(BlueprintCallable, Category="Modular Inventory|UI")
+	void RefreshSlot(int32 SlotIndex);
+
 protected:
 	// Event handlers for inventory events
-	UFUNCTION()
-	void HandleItemAdded(const FInventoryEntry& Item);
-
-	UFUNCTION()
-	void HandleItemRemoved(const FInventoryEntry& Item);
-
-	UFUNCTION()
-	void HandleItemChanged(const FInventoryEntry& Item);
+	void HandleInventoryChanged(const FInventoryChangeSet& ChangeSet);
 
 	UFUNCTION()
-	void HandleInventoryRefreshed(const TArray<FInventoryEntry>& Items);
+	void HandleMaxSlotsChanged(int32 NewMaxSlots);
 
 	UFUNCTION()
-	void HandleMaxSlotsChanged(int32 NewMaxSlots);
+	void HandlePendingSlotsChanged();
+	
+	void HandlePredictedSlotsChanged(const TArray<int32>& SlotIndices);
 
 	/** Optional: BP hook after we rebuilt the entire panel. */
 	UFUNCTION(BlueprintImplementableEvent, Category="Modular Inventory|UI")
@@ -67,4 +66,20 @@ protected:
 private:
 	UPROPERTY(EditDefaultsOnly, Category="Modular Inventory|UI")
 	int32 NumColumns = 5;
+
+	/** Live slot widgets, indexed by slot. */
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<UInventorySlotWidget>> SlotWidgets;
+
+	/** Widgets of slots that went away when MaxSlots shrank, reused when it grows again. */
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<UInventorySlotWidget>> PooledSlotWidgets;
+
+	// Item handle -> slot it is displayed in, so moved/removed items clear their old slot
+	TMap<FInventoryItemHandle, int32> DisplayedSlotByHandle;
+
+	int32 GetNumSlotsToShow() const;
+
+	/** Grows/shrinks SlotWidgets to NumSlots, going through the pool. */
+	void SetNumSlotWidgets(int32 NumSlots);
 };
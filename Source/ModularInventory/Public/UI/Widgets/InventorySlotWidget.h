@@ -23,6 +23,10 @@ public:
 	
 	UPROPERTY(BlueprintReadOnly, Category="Modular Inventory|UI")
 	bool bIsEmpty = true;
+	
+	/** Occupied on the server, but the entry has not replicated yet (paged replication). */
+	UPROPERTY(BlueprintReadOnly, Category="Modular Inventory|UI")
+	bool bIsPending = false;
 
 	/** Index of this slot in the container (optional, for grids/hotbars). */
 	UPROPERTY(BlueprintReadOnly, Category="Modular Inventory|UI")
@@ -41,6 +45,10 @@ public:
 	
 	UFUNCTION(BlueprintCallable, Category="Modular Inventory|UI")
 	void SetupEmpty(UInventoryComponent* InInventory, int32 InSlotIndex);
+	
+	/** Placeholder for an entry that is still streaming in. Behaves like an empty slot. */
+	UFUNCTION(BlueprintCallable, Category="Modular Inventory|UI")
+	void SetupPending(UInventoryComponent* InInventory, int32 InSlotIndex);
 
 protected:
 	
@@ -51,6 +59,10 @@ protected:
 	UFUNCTION(BlueprintImplementableEvent, Category="Modular Inventory|UI")
 	void OnEmptySlot();
 	
+	/** Called after SetupPending; implement in Blueprint to show a loading placeholder. */
+	UFUNCTION(BlueprintImplementableEvent, Category="Modular Inventory|UI")
+	void OnPendingSlot();
+	
 	// Drag & drop overrides
 	virtual FReply NativeOnMouseButtonDown(const FGeometry& InGeometry, const FPointerEvent& InMouseEvent) override;
 	virtual void NativeOnDragDetected(const FGeometry& InGeometry, const FPointerEvent& InMouseEvent, UDragDropOperation*& OutOperation) override;